@@ -18,7 +18,7 @@ using std::string;
  */
 
 Symbol::Symbol(const string &name, const Type &type)
-    : _name(name), _type(type), _offset(0)
+    : _name(name), _type(type), _offset(0), _addressed(false)
 {
 }
 
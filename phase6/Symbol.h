@@ -4,6 +4,10 @@
  * Description:	This file contains the class definition for symbols in
  *		Simple C.  At this point, a symbol merely consists of a
  *		name and a type, neither of which you can change.
+ *
+ *		A variable is marked as addressed if its address is ever
+ *		taken.  A function is marked as addressed if the address of
+ *		any of its local variables is ever taken.
  */
 
 # ifndef SYMBOL_H
@@ -18,6 +22,7 @@ class Symbol {
 
 public:
     int _offset;
+    bool _addressed;
 
     Symbol(const string &name, const Type &type);
     const string &name() const;
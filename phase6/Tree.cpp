@@ -78,6 +78,30 @@ Binary::Binary(Expression *left, Expression *right, const Type &type)
 }
 
 
+/*
+ * Function:	Binary::left (accessor)
+ *
+ * Description:	Return the left operand of this binary operator.
+ */
+
+Expression *Binary::left() const
+{
+    return _left;
+}
+
+
+/*
+ * Function:	Binary::right (accessor)
+ *
+ * Description:	Return the right operand of this binary operator.
+ */
+
+Expression *Binary::right() const
+{
+    return _right;
+}
+
+
 /*
  * Function:	Unary::Unary (constructor)
  *
@@ -91,6 +115,18 @@ Unary::Unary(Expression *expr, const Type &type)
 }
 
 
+/*
+ * Function:	Unary::expr (accessor)
+ *
+ * Description:	Return the operand of this unary operator.
+ */
+
+Expression *Unary::expr() const
+{
+    return _expr;
+}
+
+
 /*
  * Function:	String::String (constructor)
  *
@@ -179,6 +215,23 @@ Number::Number(const string &value)
 }
 
 
+/*
+ * Function:	Number::Number (constructor)
+ *
+ * Description:	Initialize a number with the given value and type, as
+ *		the result of folding a constant expression.
+ */
+
+Number::Number(long value, const Type &type)
+    : Expression(type)
+{
+    stringstream ss;
+
+    ss << value;
+    _value = ss.str();
+}
+
+
 /*
  * Function:	Number::value (accessor)
  *
@@ -203,6 +256,32 @@ Call::Call(const Symbol *id, const Expressions &args, const Type &type)
 }
 
 
+/*
+ * Function:	Call::id (accessor)
+ *
+ * Description:	Return the symbol of the function being called.
+ */
+
+const Symbol *Call::id() const
+{
+    return _id;
+}
+
+
+/*
+ * Function:	Inline::Inline (constructor)
+ *
+ * Description:	Initialize an inlined function call expression.  The
+ *		result is the local variable of the body that holds the
+ *		return value, and is null if the function returns void.
+ */
+
+Inline::Inline(const Symbol *id, Block *body, const Symbol *result, const Type &type)
+    : Expression(type), _id(id), _body(body), _result(result)
+{
+}
+
+
 /*
  * Function:	Not::Not (constructor)
  *
@@ -227,6 +306,18 @@ Negate::Negate(Expression *expr, const Type &type)
 }
 
 
+/*
+ * Function:	Complement::Complement (constructor)
+ *
+ * Description:	Initialize a bitwise complement expression.
+ */
+
+Complement::Complement(Expression *expr, const Type &type)
+    : Unary(expr, type)
+{
+}
+
+
 /*
  * Function:	Dereference::Dereference (constructor)
  *
@@ -324,6 +415,30 @@ Subtract::Subtract(Expression *left, Expression *right, const Type &type)
 }
 
 
+/*
+ * Function:	LeftShift::LeftShift (constructor)
+ *
+ * Description:	Initialize a left shift expression.
+ */
+
+LeftShift::LeftShift(Expression *left, Expression *right, const Type &type)
+    : Binary(left, right, type)
+{
+}
+
+
+/*
+ * Function:	RightShift::RightShift (constructor)
+ *
+ * Description:	Initialize a right shift expression.
+ */
+
+RightShift::RightShift(Expression *left, Expression *right, const Type &type)
+    : Binary(left, right, type)
+{
+}
+
+
 /*
  * Function:	LessThan::LessThan (constructor)
  *
@@ -396,6 +511,42 @@ NotEqual::NotEqual(Expression *left, Expression *right, const Type &type)
 }
 
 
+/*
+ * Function:	BitwiseAnd::BitwiseAnd (constructor)
+ *
+ * Description:	Initialize a bitwise-and expression.
+ */
+
+BitwiseAnd::BitwiseAnd(Expression *left, Expression *right, const Type &type)
+    : Binary(left, right, type)
+{
+}
+
+
+/*
+ * Function:	BitwiseXor::BitwiseXor (constructor)
+ *
+ * Description:	Initialize a bitwise exclusive-or expression.
+ */
+
+BitwiseXor::BitwiseXor(Expression *left, Expression *right, const Type &type)
+    : Binary(left, right, type)
+{
+}
+
+
+/*
+ * Function:	BitwiseOr::BitwiseOr (constructor)
+ *
+ * Description:	Initialize a bitwise-or expression.
+ */
+
+BitwiseOr::BitwiseOr(Expression *left, Expression *right, const Type &type)
+    : Binary(left, right, type)
+{
+}
+
+
 /*
  * Function:	LogicalAnd::LogicalAnd (constructor)
  *
@@ -427,8 +578,44 @@ LogicalOr::LogicalOr(Expression *left, Expression *right, const Type &type)
  */
 
 Assignment::Assignment(Expression *left, Expression *right)
-    : _left(left), _right(right)
+    : _left(left), _right(right), _dead(false)
+{
+}
+
+
+/*
+ * Function:	Assignment::left (accessor)
+ *
+ * Description:	Return the left-hand side of this assignment.
+ */
+
+Expression *Assignment::left() const
+{
+    return _left;
+}
+
+
+/*
+ * Function:	Assignment::right (accessor)
+ *
+ * Description:	Return the right-hand side of this assignment.
+ */
+
+Expression *Assignment::right() const
+{
+    return _right;
+}
+
+
+/*
+ * Function:	Assignment::dead (accessor)
+ *
+ * Description:	Return whether this assignment is never read.
+ */
+
+bool Assignment::dead() const
 {
+    return _dead;
 }
 
 
@@ -468,6 +655,18 @@ Scope *Block::declarations() const
 }
 
 
+/*
+ * Function:	Block::statements (accessor)
+ *
+ * Description:	Return the statements of this block.
+ */
+
+const Statements &Block::statements() const
+{
+    return _stmts;
+}
+
+
 /*
  * Function:	While::While (constructor)
  *
@@ -504,6 +703,87 @@ If::If(Expression *expr, Statement *thenStmt, Statement *elseStmt)
 }
 
 
+/*
+ * Function:	If::expr (accessor)
+ *
+ * Description:	Return the test of this if statement.
+ */
+
+Expression *If::expr() const
+{
+    return _expr;
+}
+
+
+/*
+ * Function:	If::thenStmt (accessor)
+ *
+ * Description:	Return the then branch of this if statement.
+ */
+
+Statement *If::thenStmt() const
+{
+    return _thenStmt;
+}
+
+
+/*
+ * Function:	If::elseStmt (accessor)
+ *
+ * Description:	Return the else branch of this if statement, which may be
+ *		null.
+ */
+
+Statement *If::elseStmt() const
+{
+    return _elseStmt;
+}
+
+
+/*
+ * Function:	Switch::Switch (constructor)
+ *
+ * Description:	Initialize a switch statement.
+ */
+
+Switch::Switch(Expression *expr, const Statements &stmts, const Cases &cases,
+	       unsigned dflt)
+    : _expr(expr), _stmts(stmts), _cases(cases), _default(dflt)
+{
+}
+
+
+/*
+ * Function:	Switch::labeled
+ *
+ * Description:	Return whether a case or default label of this switch
+ *		statement is at the given statement index.
+ */
+
+bool Switch::labeled(unsigned index) const
+{
+    if (_default == index)
+	return true;
+
+    for (auto &entry : _cases)
+	if (entry.second == index)
+	    return true;
+
+    return false;
+}
+
+
+/*
+ * Function:	Break::Break (constructor)
+ *
+ * Description:	Initialize a break statement.
+ */
+
+Break::Break()
+{
+}
+
+
 /*
  * Function:	Simple::Simple (constructor)
  *
@@ -528,6 +808,30 @@ Function::Function(const Symbol *id, Block *body)
 }
 
 
+/*
+ * Function:	Function::id (accessor)
+ *
+ * Description:	Return the symbol of this function.
+ */
+
+const Symbol *Function::id() const
+{
+    return _id;
+}
+
+
+/*
+ * Function:	Function::body (accessor)
+ *
+ * Description:	Return the body of this function.
+ */
+
+Block *Function::body() const
+{
+    return _body;
+}
+
+
 /*
  * Function:	Expression::isNumber (accessor)
  *
@@ -553,6 +857,31 @@ bool Number::isNumber(unsigned long &value) const
 }
 
 
+/*
+ * Function:	Expression::isIdentifier (accessor)
+ *
+ * Description:	Return false since most expressions are not identifiers.
+ */
+
+bool Expression::isIdentifier(const Symbol *&symbol) const
+{
+    return false;
+}
+
+
+/*
+ * Function:	Identifier::isIdentifier (accessor)
+ *
+ * Description:	Return true since an identifier is in fact an identifier.
+ */
+
+bool Identifier::isIdentifier(const Symbol *&symbol) const
+{
+    symbol = _symbol;
+    return true;
+}
+
+
 /*
  * Function:	Expression::isDereference (accessor)
  *
@@ -22,10 +22,16 @@
  *		allocator.cpp - member functions to do storage allocation
  *		generator.cpp - member functions to do code generation
  *		writer.cpp - member functions to write the tree to a stream
+ *		inliner.cpp - member functions to copy and inline trees
+ *		liveness.cpp - member functions to find dead code
+ *		propagator.cpp - member functions to propagate constants
+ *		ranger.cpp - member functions to find the ranges of values
  */
 
 # ifndef TREE_H
 # define TREE_H
+# include <map>
+# include <set>
 # include <string>
 # include <vector>
 # include <ostream>
@@ -35,6 +41,11 @@
 
 typedef std::vector<class Statement *> Statements;
 typedef std::vector<class Expression *> Expressions;
+typedef std::map<const Symbol *, Symbol *> Substitution;
+typedef std::set<const Symbol *> Variables;
+typedef std::map<const Symbol *, long> Constants;
+typedef std::map<const Symbol *, std::pair<long, long>> Ranges;
+typedef std::map<long, unsigned> Cases;
 
 
 /* The base class */
@@ -50,14 +61,27 @@ public:
     virtual void write(ostream &ostr) const = 0;
     virtual void allocate(int &offset) const {}
     virtual void generate() {}
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool pure() const;
+    virtual void liveness(Variables &live);
 };
 
 
-/* Any type of statement: return, while, if, block, and expression */
+/* Any type of statement: return, while, for, if, switch, break, block, and
+   expression */
 
 class Statement : public Node {
 protected:
     Statement() {}
+
+public:
+    virtual bool returns() const;
+    virtual bool assigns(const Symbol *symbol) const;
+    virtual void propagate(Constants &constants);
+    virtual void bound(Ranges &ranges);
+    virtual Statement *clone(Substitution &subst) const = 0;
 };
 
 
@@ -78,8 +102,14 @@ public:
 
     virtual void operand(ostream &ostr) const;
     virtual bool isDereference(Expression *&pointer) const;
+    virtual bool isIdentifier(const Symbol *&symbol) const;
     virtual bool isNumber(unsigned long &value) const;
+    virtual string key() const;
     virtual void test(const Label& label, bool ifTrue);
+    virtual bool constant(const Constants &constants, long &value) const;
+    virtual bool range(const Ranges &ranges, long &low, long &high) const;
+    virtual Expression *fold(Constants &constants);
+    virtual Expression *clone(Substitution &subst) const = 0;
 };
 
 
@@ -89,6 +119,20 @@ class Binary : public Expression {
 protected:
     Expression *_left, *_right;
     Binary(Expression *left, Expression *right, const Type &type);
+
+public:
+    Expression *left() const;
+    Expression *right() const;
+    virtual void allocate(int &offset) const;
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool pure() const;
+    virtual void liveness(Variables &live);
+    virtual bool constant(const Constants &constants, long &value) const;
+    virtual bool range(const Ranges &ranges, long &low, long &high) const;
+    virtual Expression *fold(Constants &constants);
+    virtual string key() const;
 };
 
 
@@ -98,6 +142,19 @@ class Unary : public Expression {
 protected:
     Expression *_expr;
     Unary(Expression *expr, const Type &type);
+
+public:
+    Expression *expr() const;
+    virtual void allocate(int &offset) const;
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool pure() const;
+    virtual void liveness(Variables &live);
+    virtual bool constant(const Constants &constants, long &value) const;
+    virtual bool range(const Ranges &ranges, long &low, long &high) const;
+    virtual Expression *fold(Constants &constants);
+    virtual string key() const;
 };
 
 
@@ -111,6 +168,7 @@ public:
     const string &value() const;
     virtual void write(ostream &ostr) const;
     virtual void operand(ostream &ostr) const;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -124,6 +182,12 @@ public:
     const Symbol *symbol() const;
     virtual void write(ostream &ostr) const;
     virtual void operand(ostream &ostr) const;
+    virtual bool isIdentifier(const Symbol *&symbol) const;
+    virtual void liveness(Variables &live);
+    virtual bool constant(const Constants &constants, long &value) const;
+    virtual bool range(const Ranges &ranges, long &low, long &high) const;
+    virtual string key() const;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -135,10 +199,16 @@ class Number : public Expression {
 public:
     Number(unsigned long value);
     Number(const string &value);
+    Number(long value, const Type &type);
     const string &value() const;
     virtual void write(ostream &ostr) const;
     virtual void operand(ostream &ostr) const;
+    virtual void generate();
     virtual bool isNumber(unsigned long &value) const;
+    virtual bool constant(const Constants &constants, long &value) const;
+    virtual bool range(const Ranges &ranges, long &low, long &high) const;
+    virtual string key() const;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -150,8 +220,43 @@ class Call : public Expression {
 
 public:
     Call(const Symbol *id, const Expressions &args, const Type &type);
+    const Symbol *id() const;
+    virtual void write(ostream &ostr) const;
+    virtual void allocate(int &offset) const;
+    virtual void generate();
+    bool generateTail();
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool pure() const;
+    virtual void liveness(Variables &live);
+    virtual Expression *fold(Constants &constants);
+    virtual Expression *clone(Substitution &subst) const;
+};
+
+
+/* An inlined function call expression, whose body is a copy of the body
+   of the called function preceded by assignments of the arguments to the
+   copies of its parameters */
+
+class Inline : public Expression {
+    const Symbol *_id;
+    class Block *_body;
+    const Symbol *_result;
+
+public:
+    Inline(const Symbol *id, Block *body, const Symbol *result, const Type &type);
     virtual void write(ostream &ostr) const;
+    virtual void operand(ostream &ostr) const;
+    virtual void allocate(int &offset) const;
     virtual void generate();
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool pure() const;
+    virtual void liveness(Variables &live);
+    virtual Expression *fold(Constants &constants);
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -162,6 +267,7 @@ public:
     Not(Expression *expr, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -172,6 +278,18 @@ public:
     Negate(Expression *expr, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
+};
+
+
+/* A bitwise complement expression: ~ expr */
+
+class Complement : public Unary {
+public:
+    Complement(Expression *expr, const Type &type);
+    virtual void write(ostream &ostr) const;
+    virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -182,7 +300,9 @@ public:
     Dereference(Expression *expr, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual bool isDereference(Expression *&pointer) const;
+    virtual string key() const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -192,7 +312,9 @@ class Address : public Unary {
 public:
     Address(Expression *expr, const Type &type);
     virtual void write(ostream &ostr) const;
+    virtual string key() const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -203,6 +325,7 @@ public:
     Cast(Expression *expr, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -213,6 +336,7 @@ public:
     Multiply(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -223,6 +347,7 @@ public:
     Divide(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -233,6 +358,7 @@ public:
     Remainder(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -243,6 +369,7 @@ public:
     Add(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -253,6 +380,29 @@ public:
     Subtract(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
+};
+
+
+/* A left shift expression: left << right */
+
+class LeftShift : public Binary {
+public:
+    LeftShift(Expression *left, Expression *right, const Type &type);
+    virtual void write(ostream &ostr) const;
+    virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
+};
+
+
+/* A right shift expression: left >> right */
+
+class RightShift : public Binary {
+public:
+    RightShift(Expression *left, Expression *right, const Type &type);
+    virtual void write(ostream &ostr) const;
+    virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -263,6 +413,7 @@ public:
     LessThan(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -273,6 +424,7 @@ public:
     GreaterThan(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -283,6 +435,7 @@ public:
     LessOrEqual(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -293,6 +446,7 @@ public:
     GreaterOrEqual(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -303,6 +457,7 @@ public:
     Equal(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -313,6 +468,40 @@ public:
     NotEqual(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
+};
+
+
+/* A bitwise-and expression: left & right */
+
+class BitwiseAnd : public Binary {
+public:
+    BitwiseAnd(Expression *left, Expression *right, const Type &type);
+    virtual void write(ostream &ostr) const;
+    virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
+};
+
+
+/* A bitwise exclusive-or expression: left ^ right */
+
+class BitwiseXor : public Binary {
+public:
+    BitwiseXor(Expression *left, Expression *right, const Type &type);
+    virtual void write(ostream &ostr) const;
+    virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
+};
+
+
+/* A bitwise-or expression: left | right */
+
+class BitwiseOr : public Binary {
+public:
+    BitwiseOr(Expression *left, Expression *right, const Type &type);
+    virtual void write(ostream &ostr) const;
+    virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -322,7 +511,9 @@ class LogicalAnd: public Binary {
 public:
     LogicalAnd(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
+    virtual string key() const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -332,7 +523,9 @@ class LogicalOr : public Binary {
 public:
     LogicalOr(Expression *left, Expression *right, const Type &type);
     virtual void write(ostream &ostr) const;
+    virtual string key() const;
     virtual void generate() override;
+    virtual Expression *clone(Substitution &subst) const;
 };
 
 
@@ -340,11 +533,24 @@ public:
 
 class Assignment : public Statement {
     Expression *_left, *_right;
+    bool _dead;
 
 public:
     Assignment(Expression *left, Expression *right);
+    Expression *left() const;
+    Expression *right() const;
+    bool dead() const;
     virtual void write(ostream &ostr) const;
+    virtual void allocate(int &offset) const;
     virtual void generate();
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool assigns(const Symbol *symbol) const;
+    virtual void liveness(Variables &live);
+    virtual void propagate(Constants &constants);
+    virtual void bound(Ranges &ranges);
+    virtual Statement *clone(Substitution &subst) const;
 };
 
 
@@ -356,7 +562,15 @@ class Return : public Statement {
 public:
     Return(Expression *expr);
     virtual void write(ostream &ostr) const;
+    virtual void allocate(int &offset) const;
     virtual void generate();
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool returns() const;
+    virtual void liveness(Variables &live);
+    virtual void propagate(Constants &constants);
+    virtual Statement *clone(Substitution &subst) const;
 };
 
 
@@ -369,9 +583,19 @@ class Block : public Statement {
 public:
     Block(Scope *decls, const Statements &stmts);
     Scope *declarations() const;
+    const Statements &statements() const;
     virtual void write(ostream &ostr) const;
     virtual void allocate(int &offset) const;
     virtual void generate();
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool returns() const;
+    virtual bool assigns(const Symbol *symbol) const;
+    virtual void liveness(Variables &live);
+    virtual void propagate(Constants &constants);
+    virtual void bound(Ranges &ranges);
+    virtual Statement *clone(Substitution &subst) const;
 };
 
 
@@ -386,6 +610,15 @@ public:
     virtual void write(ostream &ostr) const;
     virtual void allocate(int &offset) const;
     virtual void generate() override;
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool returns() const;
+    virtual bool assigns(const Symbol *symbol) const;
+    virtual void liveness(Variables &live);
+    virtual void propagate(Constants &constants);
+    virtual void bound(Ranges &ranges);
+    virtual Statement *clone(Substitution &subst) const;
 };
 
 
@@ -402,6 +635,15 @@ public:
     virtual void write(ostream &ostr) const;
     virtual void allocate(int &offset) const;
     virtual void generate() override;
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool returns() const;
+    virtual bool assigns(const Symbol *symbol) const;
+    virtual void liveness(Variables &live);
+    virtual void propagate(Constants &constants);
+    virtual void bound(Ranges &ranges);
+    virtual Statement *clone(Substitution &subst) const;
 };
 
 
@@ -413,9 +655,63 @@ class If : public Statement {
 
 public:
     If(Expression *expr, Statement *thenStmt, Statement *elseStmt);
+    Expression *expr() const;
+    Statement *thenStmt() const;
+    Statement *elseStmt() const;
     virtual void write(ostream &ostr) const;
     virtual void allocate(int &offset) const;
     virtual void generate() override;
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool returns() const;
+    virtual bool assigns(const Symbol *symbol) const;
+    virtual void liveness(Variables &live);
+    virtual void propagate(Constants &constants);
+    virtual void bound(Ranges &ranges);
+    virtual Statement *clone(Substitution &subst) const;
+};
+
+
+/* A switch statement: switch ( expr ) { stmts }, where each case value and
+   the default label give the index of the statement at which they start,
+   and an index past the last statement is the end of the switch */
+
+class Switch : public Statement {
+    Expression *_expr;
+    Statements _stmts;
+    Cases _cases;
+    unsigned _default;
+
+public:
+    Switch(Expression *expr, const Statements &stmts, const Cases &cases,
+	   unsigned dflt);
+    bool labeled(unsigned index) const;
+    virtual void write(ostream &ostr) const;
+    virtual void allocate(int &offset) const;
+    virtual void generate();
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual bool assigns(const Symbol *symbol) const;
+    virtual void liveness(Variables &live);
+    virtual void propagate(Constants &constants);
+    virtual void bound(Ranges &ranges);
+    virtual Statement *clone(Substitution &subst) const;
+};
+
+
+/* A break statement, which leaves the enclosing switch statement */
+
+class Break : public Statement {
+public:
+    Break();
+    virtual void write(ostream &ostr) const;
+    virtual void generate();
+    virtual bool returns() const;
+    virtual void liveness(Variables &live);
+    virtual void propagate(Constants &constants);
+    virtual Statement *clone(Substitution &subst) const;
 };
 
 
@@ -427,7 +723,14 @@ class Simple : public Statement {
 public:
     Simple(Expression *expr);
     virtual void write(ostream &ostr) const;
+    virtual void allocate(int &offset) const;
     virtual void generate();
+    virtual unsigned cost() const;
+    virtual bool calls() const;
+    virtual bool loops() const;
+    virtual void liveness(Variables &live);
+    virtual void propagate(Constants &constants);
+    virtual Statement *clone(Substitution &subst) const;
 };
 
 
@@ -439,9 +742,14 @@ class Function : public Node {
 
 public:
     Function(const Symbol *id, Block *body);
+    const Symbol *id() const;
+    Block *body() const;
     virtual void write(ostream &ostr) const;
-    virtual void allocate(int &offset) const;
+    void allocate(int &offset, unsigned &outgoing) const;
     virtual void generate();
+    virtual void liveness(Variables &live);
+    void propagate(Constants &constants);
+    void bound(Ranges &ranges);
 };
 
 # endif /* TREE_H */
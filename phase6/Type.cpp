@@ -247,6 +247,12 @@ ostream &operator <<(ostream &ostr, const Type &type)
 	    ostr << "int";
 	else if (type.specifier() == LONG)
 	    ostr << "long";
+	else if (type.specifier() == UNSIGNED_CHAR)
+	    ostr << "unsigned char";
+	else if (type.specifier() == UNSIGNED_INT)
+	    ostr << "unsigned";
+	else if (type.specifier() == UNSIGNED_LONG)
+	    ostr << "unsigned long";
 	else if (type.specifier() == VOID)
 	    ostr << "void";
 	else
@@ -291,6 +297,22 @@ bool Type::isNumeric() const
 }
 
 
+/*
+ * Function:	Type::isUnsigned
+ *
+ * Description:	Check if this type is an unsigned numeric type.
+ */
+
+bool Type::isUnsigned() const
+{
+    if (!isNumeric())
+	return false;
+
+    return _specifier == UNSIGNED_CHAR || _specifier == UNSIGNED_INT ||
+	_specifier == UNSIGNED_LONG;
+}
+
+
 /*
  * Function:	Type::isPredicate
  *
@@ -331,13 +353,15 @@ bool Type::isCompatibleWith(const Type &that) const
  *
  * Description:	Return the result of performing type promotion on this
  *		type.  In Simple C, a character is promoted to an integer,
- *		and an array is promoted to a pointer.
+ *		even if it is unsigned, and an array is promoted to a
+ *		pointer.
  */
 
 Type Type::promote() const
 {
-    if (_declarator == SCALAR && _indirection == 0 && _specifier == CHAR)
-	return Type(INT, 0);
+    if (_declarator == SCALAR && _indirection == 0)
+	if (_specifier == CHAR || _specifier == UNSIGNED_CHAR)
+	    return Type(INT, 0);
 
     if (_declarator == ARRAY)
 	return Type(_specifier, _indirection + 1);
@@ -358,3 +382,22 @@ Type Type::deref() const
     assert(_declarator == SCALAR && _indirection > 0);
     return Type(_specifier, _indirection - 1);
 }
+
+
+/*
+ * Function:	Type::normalize
+ *
+ * Description:	Return the given value converted to this type.  A value of
+ *		an unsigned type smaller than a long is never negative.
+ */
+
+long Type::normalize(long value) const
+{
+    if (size() == 1)
+	return isUnsigned() ? (unsigned char) value : (signed char) value;
+
+    if (size() == 4)
+	return isUnsigned() ? (long) (unsigned) value : (int) value;
+
+    return value;
+}
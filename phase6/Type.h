@@ -58,13 +58,16 @@ public:
 
     bool isPointer() const;
     bool isNumeric() const;
+    bool isUnsigned() const;
     bool isPredicate() const;
     bool isCompatibleWith(const Type &that) const;
 
     Type promote() const;
     Type deref() const;
+    long normalize(long value) const;
 
     unsigned long size() const;
+    unsigned long alignment() const;
 };
 
 std::ostream &operator <<(std::ostream &ostr, const Type &type);
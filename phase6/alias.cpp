@@ -0,0 +1,269 @@
+/*
+ * File:	alias.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		locations, and the public functions for alias analysis in
+ *		Simple C.
+ *
+ *		Two locations may alias unless one of the following holds:
+ *
+ *		- they are distinct named variables, which never overlap
+ *		- they are distinct allocations, since each allocated
+ *		  pointer is only ever assigned the results of its own
+ *		  calls to an allocation function
+ *		- one is a named variable and the other an allocation
+ *		- one is a local variable whose address is never taken,
+ *		  which can only be accessed by name
+ *		- their types differ, ignoring signedness, and neither is
+ *		  a character, since an object may only be accessed using
+ *		  its own type, its signed or unsigned counterpart, or as
+ *		  characters
+ */
+
+# include <sstream>
+# include "alias.h"
+# include "tokens.h"
+
+using namespace std;
+
+static map<const Symbol *, bool> allocated;
+
+
+/*
+ * Function:	isAllocation (private)
+ *
+ * Description:	Return whether the given expression is a call to a
+ *		function that returns newly allocated memory.
+ */
+
+static bool isAllocation(Expression *expr)
+{
+    Call *call = dynamic_cast<Call *>(expr);
+
+
+    if (call == nullptr)
+	return false;
+
+    return call->id()->name() == "malloc" || call->id()->name() == "calloc";
+}
+
+
+/*
+ * Function:	recordAssignment
+ *
+ * Description:	Record an assignment so that we know which pointer
+ *		variables are only ever assigned newly allocated memory.
+ */
+
+void recordAssignment(Expression *left, Expression *right)
+{
+    const Symbol *symbol;
+
+
+    if (left->isIdentifier(symbol) && symbol->type().isPointer()) {
+	if (isAllocation(right))
+	    allocated.insert(make_pair(symbol, true));
+	else
+	    allocated[symbol] = false;
+    }
+}
+
+
+/*
+ * Function:	isAllocated
+ *
+ * Description:	Return whether the given symbol is a local pointer
+ *		variable that is only ever assigned newly allocated memory,
+ *		and so points to memory that is not accessible through any
+ *		other allocated pointer.  A parameter has an incoming value
+ *		and the value of a variable whose address is taken may be
+ *		changed indirectly, so neither qualifies.
+ */
+
+bool isAllocated(const Symbol *symbol)
+{
+    auto entry = allocated.find(symbol);
+
+
+    if (entry == allocated.end() || !entry->second)
+	return false;
+
+    return symbol->_offset < 0 && !symbol->_addressed;
+}
+
+
+/*
+ * Function:	base (private)
+ *
+ * Description:	Return the expression from which the given pointer is
+ *		derived by pointer arithmetic.
+ */
+
+static Expression *base(Expression *pointer)
+{
+    Binary *binary;
+    Address *address;
+    Expression *expr;
+
+
+    while ((binary = dynamic_cast<Binary *>(pointer)) != nullptr) {
+	if (dynamic_cast<Add *>(binary) == nullptr)
+	    if (dynamic_cast<Subtract *>(binary) == nullptr)
+		break;
+
+	if (binary->left()->type().isPointer())
+	    pointer = binary->left();
+	else if (binary->right()->type().isPointer())
+	    pointer = binary->right();
+	else
+	    break;
+    }
+
+    address = dynamic_cast<Address *>(pointer);
+
+    if (address != nullptr && address->expr()->isDereference(expr))
+	return base(expr);
+
+    return pointer;
+}
+
+
+/*
+ * Function:	Location::Location (constructor)
+ *
+ * Description:	Initialize the location accessed by the given lvalue
+ *		expression.
+ */
+
+Location::Location(const Expression *expr)
+    : _symbol(nullptr), _site(nullptr), _type(expr->type())
+{
+    Expression *pointer;
+    Address *address;
+    const Symbol *symbol;
+    ostringstream ostr;
+
+
+    if (!expr->isIdentifier(_symbol) && expr->isDereference(pointer)) {
+	pointer = base(pointer);
+	address = dynamic_cast<Address *>(pointer);
+
+	if (address != nullptr)
+	    address->expr()->isIdentifier(_symbol);
+	else if (pointer->isIdentifier(symbol) && isAllocated(symbol))
+	    _site = symbol;
+    }
+
+    if (_symbol != nullptr)
+	ostr << _symbol->name() << "@" << _symbol;
+    else if (_site != nullptr)
+	ostr << "*" << _site->name() << "@" << _site;
+    else
+	ostr << "*(" << _type << ")";
+
+    _name = ostr.str();
+}
+
+
+/*
+ * Function:	Location::name (accessor)
+ *
+ * Description:	Return the name of this location.
+ */
+
+const string &Location::name() const
+{
+    return _name;
+}
+
+
+/*
+ * Function:	Location::symbol (accessor)
+ *
+ * Description:	Return the variable named by this location, or a null
+ *		pointer if the location is not a named variable.
+ */
+
+const Symbol *Location::symbol() const
+{
+    return _symbol;
+}
+
+
+/*
+ * Function:	Location::isPrivate
+ *
+ * Description:	Return whether this location is a local variable whose
+ *		address is never taken, and which therefore can only be
+ *		accessed by name within its own function.
+ */
+
+bool Location::isPrivate() const
+{
+    return _symbol != nullptr && _symbol->_offset != 0 && !_symbol->_addressed;
+}
+
+
+/*
+ * Function:	Location::escapes
+ *
+ * Description:	Return whether this location may be accessed by a called
+ *		function, which is true of every location that is not
+ *		private.
+ */
+
+bool Location::escapes() const
+{
+    return !isPrivate();
+}
+
+
+/*
+ * Function:	plain (private)
+ *
+ * Description:	Return the given type with any signedness removed, so that
+ *		a numeric type compares equal to its unsigned counterpart.
+ */
+
+static Type plain(const Type &type)
+{
+    if (!type.isUnsigned())
+	return type;
+
+    if (type.specifier() == UNSIGNED_CHAR)
+	return Type(CHAR);
+
+    if (type.specifier() == UNSIGNED_INT)
+	return Type(INT);
+
+    return Type(LONG);
+}
+
+
+/*
+ * Function:	Location::mayAlias
+ *
+ * Description:	Return whether this location and the given location may
+ *		refer to the same memory.
+ */
+
+bool Location::mayAlias(const Location &that) const
+{
+    Type character(CHAR);
+
+
+    if (_name == that._name)
+	return true;
+
+    if (_symbol != nullptr || _site != nullptr)
+	if (that._symbol != nullptr || that._site != nullptr)
+	    return false;
+
+    if (isPrivate() || that.isPrivate())
+	return false;
+
+    if (plain(_type) == character || plain(that._type) == character)
+	return true;
+
+    return plain(_type) == plain(that._type);
+}
@@ -0,0 +1,40 @@
+/*
+ * File:	alias.h
+ *
+ * Description:	This file contains the class definition and public
+ *		function declarations for alias analysis in Simple C.
+ *
+ *		A location is the abstract object accessed by an lvalue
+ *		expression.  It is either a named variable, the memory
+ *		allocated for a pointer variable that is only ever assigned
+ *		the result of a call to an allocation function, or else an
+ *		unknown object of the type being accessed.  Locations are
+ *		compared by name, and two locations with the same name are
+ *		always the same location.
+ */
+
+# ifndef ALIAS_H
+# define ALIAS_H
+# include <string>
+# include "Tree.h"
+
+class Location {
+    typedef std::string string;
+    const Symbol *_symbol;
+    const Symbol *_site;
+    Type _type;
+    string _name;
+
+public:
+    Location(const Expression *expr);
+    const string &name() const;
+    const Symbol *symbol() const;
+    bool isPrivate() const;
+    bool escapes() const;
+    bool mayAlias(const Location &that) const;
+};
+
+void recordAssignment(Expression *left, Expression *right);
+bool isAllocated(const Symbol *symbol);
+
+# endif /* ALIAS_H */
@@ -8,17 +8,26 @@
  *		Extra functionality:
  *		- maintaining minimum offset in nested blocks
  *		- allocation within statements
+ *		- allocation within expressions for inlined calls
+ *		- detecting leaf functions
+ *		- preallocating space for outgoing arguments
+ *		- aligning variables, largest alignment first
  */
 
+# include <algorithm>
 # include <cassert>
 # include <iostream>
 # include "checker.h"
 # include "machine.h"
+# include "options.h"
 # include "tokens.h"
 # include "Tree.h"
 
 using namespace std;
 
+static unsigned arguments;
+static int bias;
+
 
 /*
  * Function:	Type::size
@@ -37,19 +46,83 @@ unsigned long Type::size() const
     if (_indirection > 0)
 	return count * SIZEOF_PTR;
 
-    if (_specifier == CHAR)
+    if (_specifier == CHAR || _specifier == UNSIGNED_CHAR)
 	return count * SIZEOF_CHAR;
 
-    if (_specifier == INT)
+    if (_specifier == INT || _specifier == UNSIGNED_INT)
 	return count * SIZEOF_INT;
 
-    if (_specifier == LONG)
+    if (_specifier == LONG || _specifier == UNSIGNED_LONG)
 	return count * SIZEOF_LONG;
 
     return 0;
 }
 
 
+/*
+ * Function:	Type::alignment
+ *
+ * Description:	Return the natural alignment of a type in bytes, which is
+ *		the size of a single element.
+ */
+
+unsigned long Type::alignment() const
+{
+    assert(_declarator != FUNCTION && _declarator != ERROR);
+    return Type(_specifier, _indirection).size();
+}
+
+
+/*
+ * Function:	alignment (private)
+ *
+ * Description:	Return the alignment of a variable of the given type on
+ *		the stack.  An array large enough to hold a vector is
+ *		aligned so that it can be accessed using aligned vector
+ *		loads, but never beyond the alignment of the stack itself.
+ */
+
+static unsigned alignment(const Type &type)
+{
+    if (type.isArray() && type.size() >= SIZEOF_VECTOR)
+	return min(array_alignment, (unsigned) STACK_ALIGNMENT);
+
+    return type.alignment();
+}
+
+
+/*
+ * Function:	before (private)
+ *
+ * Description:	Return whether the first symbol should be allocated before
+ *		the second, which is if it has a larger alignment.
+ */
+
+static bool before(const Symbol *first, const Symbol *second)
+{
+    return alignment(first->type()) > alignment(second->type());
+}
+
+
+/*
+ * Function:	align (private)
+ *
+ * Description:	Return the given offset moved down to the given alignment.
+ *		Offsets are relative to the base pointer, which lies the
+ *		given bias below an aligned address.
+ */
+
+static int align(int offset, unsigned alignment)
+{
+    int remainder = (offset - bias) % (int) alignment;
+
+    if (remainder < 0)
+	remainder += alignment;
+
+    return offset - remainder;
+}
+
+
 /*
  * Function:	Block::allocate
  *
@@ -58,18 +131,23 @@ unsigned long Type::size() const
  *		then for all symbols declared within any nested block.
  *		Only symbols that have not already been allocated an offset
  *		will be assigned one, since the parameters are already
- *		assigned special offsets.
+ *		assigned special offsets.  Each symbol is aligned, and
+ *		those with the largest alignment are allocated first so
+ *		that little space is lost to padding.
  */
 
 void Block::allocate(int &offset) const
 {
     int temp, saved;
-    const Symbols &symbols = _decls->symbols();
+    Symbols symbols = _decls->symbols();
 
 
+    stable_sort(symbols.begin(), symbols.end(), before);
+
     for (auto symbol : symbols)
 	if (symbol->_offset == 0) {
 	    offset -= symbol->type().size();
+	    offset = align(offset, alignment(symbol->type()));
 	    symbol->_offset = offset;
 	}
 
@@ -83,16 +161,120 @@ void Block::allocate(int &offset) const
 }
 
 
+/*
+ * Function:	Binary::allocate
+ *
+ * Description:	Allocate storage for any inlined calls within this
+ *		expression.  Storage within an expression is never shared,
+ *		since the value of one operand is needed while the other
+ *		is being computed.
+ */
+
+void Binary::allocate(int &offset) const
+{
+    _left->allocate(offset);
+    _right->allocate(offset);
+}
+
+
+/*
+ * Function:	Unary::allocate
+ *
+ * Description:	Allocate storage for any inlined calls within this
+ *		expression.
+ */
+
+void Unary::allocate(int &offset) const
+{
+    _expr->allocate(offset);
+}
+
+
+/*
+ * Function:	Call::allocate
+ *
+ * Description:	Allocate storage for any inlined calls within the
+ *		arguments of this call, and note the space needed for any
+ *		arguments passed on the stack.
+ */
+
+void Call::allocate(int &offset) const
+{
+    for (auto arg : _args)
+	arg->allocate(offset);
+
+    if (_args.size() > NUM_PARAM_REGS)
+	arguments = max(arguments, (unsigned)
+			(_args.size() - NUM_PARAM_REGS) * SIZEOF_PARAM);
+}
+
+
+/*
+ * Function:	Inline::allocate
+ *
+ * Description:	Allocate storage for this inlined call, which means
+ *		allocating storage for the copies of the parameters and
+ *		local variables of the function, including the variable
+ *		for the return value.
+ */
+
+void Inline::allocate(int &offset) const
+{
+    _body->allocate(offset);
+}
+
+
+/*
+ * Function:	Assignment::allocate
+ *
+ * Description:	Allocate storage for any inlined calls within this
+ *		assignment statement.
+ */
+
+void Assignment::allocate(int &offset) const
+{
+    _left->allocate(offset);
+    _right->allocate(offset);
+}
+
+
+/*
+ * Function:	Return::allocate
+ *
+ * Description:	Allocate storage for any inlined calls within this return
+ *		statement.
+ */
+
+void Return::allocate(int &offset) const
+{
+    _expr->allocate(offset);
+}
+
+
+/*
+ * Function:	Simple::allocate
+ *
+ * Description:	Allocate storage for any inlined calls within this simple
+ *		statement.
+ */
+
+void Simple::allocate(int &offset) const
+{
+    _expr->allocate(offset);
+}
+
+
 /*
  * Function:	While::allocate
  *
  * Description:	Allocate storage for this while statement, which
  *		essentially means allocating storage for variables declared
- *		as part of its statement.
+ *		as part of its statement and for any inlined calls.
  */
 
 void While::allocate(int &offset) const
 {
+    _expr->allocate(offset);
     _stmt->allocate(offset);
 }
 
@@ -102,11 +284,14 @@ void While::allocate(int &offset) const
  *
  * Description:	Allocate storage for this for statement, which
  *		essentially means allocating storage for variables declared
- *		as part of its statement.
+ *		as part of its statement and for any inlined calls.
  */
 
 void For::allocate(int &offset) const
 {
+    _init->allocate(offset);
+    _expr->allocate(offset);
+    _incr->allocate(offset);
     _stmt->allocate(offset);
 }
 
@@ -116,7 +301,8 @@ void For::allocate(int &offset) const
  *
  * Description:	Allocate storage for this if-then or if-then-else
  *		statement, which essentially means allocating storage for
- *		variables declared as part of its statements.
+ *		variables declared as part of its statements and for any
+ *		inlined calls.
  */
 
 void If::allocate(int &offset) const
@@ -124,6 +310,7 @@ void If::allocate(int &offset) const
     int saved, temp;
 
 
+    _expr->allocate(offset);
     saved = offset;
     _thenStmt->allocate(offset);
 
@@ -135,14 +322,135 @@ void If::allocate(int &offset) const
 }
 
 
+/*
+ * Function:	Switch::allocate
+ *
+ * Description:	Allocate storage for this switch statement.  Just as for
+ *		a block, the statements may share storage, since control
+ *		can only fall from one into the next.
+ */
+
+void Switch::allocate(int &offset) const
+{
+    int temp, saved;
+
+
+    _expr->allocate(offset);
+    saved = offset;
+
+    for (auto stmt : _stmts) {
+	temp = saved;
+	stmt->allocate(temp);
+	offset = min(offset, temp);
+    }
+}
+
+
+/*
+ * Function:	Node::calls
+ *
+ * Description:	Return whether this node contains a function call, in
+ *		which case the function containing it is not a leaf and
+ *		needs a stack frame.
+ */
+
+bool Node::calls() const
+{
+    return false;
+}
+
+
+/*
+ * The remaining functions simply check the children of each node, and
+ * aren't very interesting.  Note that an inlined call is not a call.
+ */
+
+bool Unary::calls() const
+{
+    return _expr->calls();
+}
+
+bool Binary::calls() const
+{
+    return _left->calls() || _right->calls();
+}
+
+bool Call::calls() const
+{
+    return true;
+}
+
+bool Inline::calls() const
+{
+    return _body->calls();
+}
+
+bool Assignment::calls() const
+{
+    return _left->calls() || _right->calls();
+}
+
+bool Return::calls() const
+{
+    return _expr->calls();
+}
+
+bool Block::calls() const
+{
+    for (auto stmt : _stmts)
+	if (stmt->calls())
+	    return true;
+
+    return false;
+}
+
+bool While::calls() const
+{
+    return _expr->calls() || _stmt->calls();
+}
+
+bool For::calls() const
+{
+    return _init->calls() || _expr->calls() || _incr->calls() || _stmt->calls();
+}
+
+bool If::calls() const
+{
+    if (_expr->calls() || _thenStmt->calls())
+	return true;
+
+    return _elseStmt != nullptr && _elseStmt->calls();
+}
+
+bool Switch::calls() const
+{
+    if (_expr->calls())
+	return true;
+
+    for (auto stmt : _stmts)
+	if (stmt->calls())
+	    return true;
+
+    return false;
+}
+
+bool Simple::calls() const
+{
+    return _expr->calls();
+}
+
+
 /*
  * Function:	Function::allocate
  *
  * Description:	Allocate storage for this function and return the number of
  *		bytes required.  The parameters are allocated offsets as
- *		well, starting with the given offset.  This function is
- *		designed to work with both 32-bit and 64-bit Intel
- *		architectures, with or without callee-saved registers.
+ *		well, starting with the given offset.  The number of bytes
+ *		needed for arguments passed on the stack by any call is
+ *		also returned, since that space is allocated just once at
+ *		the bottom of our frame.  This function is designed to work
+ *		with both 32-bit and 64-bit Intel architectures, with or
+ *		without callee-saved registers.
  *
  *		32-bit Intel/Linux:
  *		  SIZEOF_PARAM = 0 (each parameter has its own size)
@@ -156,14 +464,18 @@ void If::allocate(int &offset) const
  *		first parameter on the stack.  Normally, this value is the
  *		size of two registers (the instruction pointer and the base
  *		pointer), but would be larger if additional callee-saved
- *		registers were used.
+ *		registers were used.  The address of the first parameter
+ *		on the stack is aligned, which tells us the alignment of
+ *		every other offset.
  */
 
-void Function::allocate(int &offset) const
+void Function::allocate(int &offset, unsigned &outgoing) const
 {
     Parameters *params = _id->type().parameters();
     const Symbols &symbols = _body->declarations()->symbols();
 
+    bias = offset;
+
     for (unsigned i = NUM_PARAM_REGS; i < params->size(); i ++) {
 	symbols[i]->_offset = offset;
 	offset += (SIZEOF_PARAM ? SIZEOF_PARAM : (*params)[i].promote().size());
@@ -174,9 +486,12 @@ void Function::allocate(int &offset) const
     for (unsigned i = 0; i < NUM_PARAM_REGS; i ++)
 	if (i < params->size()) {
 	    offset -= (*params)[i].promote().size();
+	    offset = align(offset, (*params)[i].promote().size());
 	    symbols[i]->_offset = offset;
 	} else
 	    break;
 
+    arguments = 0;
     _body->allocate(offset);
+    outgoing = arguments;
 }
@@ -11,11 +11,15 @@
  *		- inserting an undeclared symbol with the error type
  *		- scaling the operands and results of pointer arithmetic
  *		- explicit type conversions and promotions
+ *		- inlining calls to small functions
+ *		- recording assignments for alias analysis
  */
 
 # include <iostream>
 # include "lexer.h"
 # include "checker.h"
+# include "inliner.h"
+# include "alias.h"
 # include "tokens.h"
 # include "Symbol.h"
 # include "Scope.h"
@@ -25,8 +29,9 @@
 using namespace std;
 
 static Scope *outermost, *toplevel;
+static Symbol *function;
 static const Type error, voidptr(VOID, 1);
-static const Type integer(INT), character(CHAR), longint(LONG);
+static const Type integer(INT), longint(LONG);
 
 static string redefined = "redefinition of '%s'";
 static string redeclared = "redeclaration of '%s'";
@@ -41,6 +46,11 @@ static string invalid_operands = "invalid operands to binary %s";
 static string invalid_operand = "invalid operand to unary %s";
 static string invalid_function = "called object is not a function";
 static string invalid_arguments = "invalid arguments to called function";
+static string invalid_switch = "invalid type for switch expression";
+static string invalid_case = "case label does not reduce to an integer constant";
+static string duplicate_case = "duplicate case value";
+static string duplicate_default = "multiple default labels in one switch";
+static string invalid_break = "break statement not within switch";
 
 
 /*
@@ -53,23 +63,53 @@ static void debug(const string &str, const Type &t1, const Type &t2)
 }
 
 
+/*
+ * Function:	escape
+ *
+ * Description:	Note that the address of the given expression is taken.  If
+ *		the expression is a variable, then it is marked as
+ *		addressed, and if it is a local variable, then so is the
+ *		function being defined, since its frame is then visible
+ *		outside of the function.
+ */
+
+static void escape(Expression *expr)
+{
+    const Symbol *id;
+    Symbol *symbol;
+
+
+    if (expr->isIdentifier(id)) {
+	symbol = toplevel->lookup(id->name());
+
+	if (symbol == id) {
+	    symbol->_addressed = true;
+
+	    if (function != nullptr && outermost->find(id->name()) != symbol)
+		function->_addressed = true;
+	}
+    }
+}
+
+
 /*
  * Function:	promote
  *
  * Description:	Perform type promotion on the given expression.  An array
  *		is promoted to a pointer by explicitly inserting an address
- *		operator.  A character is promoted to an integer by
- *		explicitly inserting a type cast.
+ *		operator.  A character, signed or unsigned, is promoted to
+ *		an integer by explicitly inserting a type cast.
  */
 
 static Type promote(Expression *&expr)
 {
     if (expr->type().isArray()) {
 	debug("promoting", expr->type(), expr->type().promote());
+	escape(expr);
 	expr = new Address(expr, expr->type().promote());
 
-    } else if (expr->type() == character) {
-	debug("promoting", character, integer);
+    } else if (expr->type().isNumeric() && expr->type().size() == 1) {
+	debug("promoting", expr->type(), integer);
 	expr = new Cast(expr, integer);
     }
 
@@ -125,22 +165,45 @@ static Type convert(Expression *&expr, Type type)
 }
 
 
+/*
+ * Function:	common
+ *
+ * Description:	Return the type to which the operands of an arithmetic
+ *		operator with the given promoted types are converted.  The
+ *		larger type is used, and between types of the same size,
+ *		the unsigned type is used.  An unsigned int therefore
+ *		becomes a long rather than an unsigned long, since a long
+ *		can hold every value.
+ */
+
+static Type common(const Type &t1, const Type &t2)
+{
+    if (t1.size() != t2.size())
+	return t1.size() > t2.size() ? t1 : t2;
+
+    return t1.isUnsigned() ? t1 : t2;
+}
+
+
 /*
  * Function:	extend
  *
  * Description:	Attempt to extend the type of the given expression to the
  *		given type.  The type of the given expression is only
- *		extended, not truncated.  We ensure this by checking that
- *		either the source type is char or the target type is long.
+ *		extended, not truncated.  We ensure this by converting it
+ *		to the common type of the two types after promotion.
  */
 
 static Type extend(Expression *&expr, Type type)
 {
-    if (expr->type() != type && expr->type().isNumeric() && type.isNumeric())
-	if (expr->type() == character || type == longint) {
+    if (expr->type().isNumeric() && type.isNumeric()) {
+	type = common(expr->type().promote(), type.promote());
+
+	if (expr->type() != type) {
 	    debug("extending", expr->type(), type);
 	    expr = cast(expr, type);
 	}
+    }
 
     return promote(expr);
 }
@@ -205,7 +268,8 @@ Scope *closeScope()
  * Description:	Define a function with the specified NAME and TYPE.  A
  *		function is always defined in the outermost scope.  This
  *		definition always replaces any previous definition or
- *		declaration.
+ *		declaration.  The function is remembered as the one being
+ *		defined.
  */
 
 Symbol *defineFunction(const string &name, const Type &type)
@@ -226,6 +290,7 @@ Symbol *defineFunction(const string &name, const Type &type)
 
     symbol = new Symbol(name, type);
     outermost->insert(symbol);
+    function = symbol;
     return symbol;
 }
 
@@ -312,7 +377,7 @@ Symbol *checkIdentifier(const string &name)
  *
  * Description:	Check a function call expression: symbol (args).  The
  *		symbol must have a function type, and the number and types
- *		of the arguments must agree.
+ *		of the arguments must agree.  A valid call may be inlined.
  */
 
 Expression *checkCall(Symbol *symbol, Expressions &args)
@@ -320,6 +385,7 @@ Expression *checkCall(Symbol *symbol, Expressions &args)
     const Type &t = symbol->type();
     Type result = error;
     Parameters *params;
+    Expression *expr;
 
 
     if (t != error) {
@@ -356,6 +422,13 @@ Expression *checkCall(Symbol *symbol, Expressions &args)
 	    report(invalid_function);
     }
 
+    if (result != error && (expr = inlineCall(symbol, args, result)) != nullptr) {
+	if (symbol->_addressed && function != nullptr)
+	    function->_addressed = true;
+
+	return expr;
+    }
+
     return new Call(symbol, args, result);
 }
 
@@ -436,6 +509,31 @@ Expression *checkNegate(Expression *expr)
 }
 
 
+/*
+ * Function:	checkComplement
+ *
+ * Description:	Check a bitwise complement expression: ~ expr.  The
+ *		operand must have a numeric type, and the result has that
+ *		type.
+ */
+
+Expression *checkComplement(Expression *expr)
+{
+    const Type &t = promote(expr);
+    Type result = error;
+
+
+    if (t != error) {
+	if (t.isNumeric())
+	    result = t;
+	else
+	    report(invalid_operand, "~");
+    }
+
+    return new Complement(expr, result);
+}
+
+
 /*
  * Function:	checkDereference
  *
@@ -475,9 +573,10 @@ Expression *checkAddress(Expression *expr)
 
 
     if (t != error) {
-	if (expr->lvalue())
+	if (expr->lvalue()) {
 	    result = Type(t.specifier(), t.indirection() + 1);
-	else
+	    escape(expr);
+	} else
 	    report(invalid_lvalue);
     }
 
@@ -666,6 +765,61 @@ Expression *checkSubtract(Expression *left, Expression *right)
 }
 
 
+/*
+ * Function:	checkShift
+ *
+ * Description:	Check a shift expression: both operands must have numeric
+ *		types, and the result has the type of the left operand
+ *		after promotion.  Unlike other operators, the operands are
+ *		not converted to a common type, since the right operand is
+ *		only a count.
+ */
+
+static Type
+checkShift(Expression *&left, Expression *&right, const string &op)
+{
+    const Type &t1 = promote(left);
+    const Type &t2 = promote(right);
+    Type result = error;
+
+
+    if (t1 != error && t2 != error) {
+	if (t1.isNumeric() && t2.isNumeric())
+	    result = t1;
+	else
+	    report(invalid_operands, op);
+    }
+
+    return result;
+}
+
+
+/*
+ * Function:	checkLeftShift
+ *
+ * Description:	Check a left shift expression: left << right.
+ */
+
+Expression *checkLeftShift(Expression *left, Expression *right)
+{
+    Type t = checkShift(left, right, "<<");
+    return new LeftShift(left, right, t);
+}
+
+
+/*
+ * Function:	checkRightShift
+ *
+ * Description:	Check a right shift expression: left >> right.
+ */
+
+Expression *checkRightShift(Expression *left, Expression *right)
+{
+    Type t = checkShift(left, right, ">>");
+    return new RightShift(left, right, t);
+}
+
+
 /*
  * Function:	checkRelational
  *
@@ -799,6 +953,72 @@ Expression *checkNotEqual(Expression *left, Expression *right)
 }
 
 
+/*
+ * Function:	checkBitwise
+ *
+ * Description:	Check a bitwise-and, bitwise-xor, or bitwise-or
+ *		expression: both operands must have numeric types, and the
+ *		result has their common type.
+ */
+
+static Type
+checkBitwise(Expression *&left, Expression *&right, const string &op)
+{
+    const Type &t1 = extend(left, right->type());
+    const Type &t2 = extend(right, left->type());
+    Type result = error;
+
+
+    if (t1 != error && t2 != error) {
+	if (t1.isNumeric() && t2.isNumeric())
+	    result = t1;
+	else
+	    report(invalid_operands, op);
+    }
+
+    return result;
+}
+
+
+/*
+ * Function:	checkBitwiseAnd
+ *
+ * Description:	Check a bitwise-and expression: left & right.
+ */
+
+Expression *checkBitwiseAnd(Expression *left, Expression *right)
+{
+    Type t = checkBitwise(left, right, "&");
+    return new BitwiseAnd(left, right, t);
+}
+
+
+/*
+ * Function:	checkBitwiseXor
+ *
+ * Description:	Check a bitwise exclusive-or expression: left ^ right.
+ */
+
+Expression *checkBitwiseXor(Expression *left, Expression *right)
+{
+    Type t = checkBitwise(left, right, "^");
+    return new BitwiseXor(left, right, t);
+}
+
+
+/*
+ * Function:	checkBitwiseOr
+ *
+ * Description:	Check a bitwise-or expression: left | right.
+ */
+
+Expression *checkBitwiseOr(Expression *left, Expression *right)
+{
+    Type t = checkBitwise(left, right, "|");
+    return new BitwiseOr(left, right, t);
+}
+
+
 /*
  * Function:	checkLogical
  *
@@ -873,10 +1093,78 @@ Statement *checkAssignment(Expression *left, Expression *right)
 	    report(invalid_operands, "=");
     }
 
+    recordAssignment(left, right);
     return new Assignment(left, right);
 }
 
 
+/*
+ * Function:	checkCompound
+ *
+ * Description:	Check a compound assignment statement, such as left +=
+ *		right, or an increment or decrement, which is left += 1 or
+ *		left -= 1.  The statement is checked as the assignment left
+ *		= left op right, so the usual conversions apply and the
+ *		code generator can later recognize it as a read, modify,
+ *		and write of a single location.  The left operand must only
+ *		be evaluated once, so if it has side effects, its address
+ *		is first assigned to a new local variable.
+ */
+
+Statement *checkCompound(Expression *left, int op, Expression *right)
+{
+    Expression *pointer, *value;
+    Substitution subst;
+    Statements stmts;
+    Symbol *symbol;
+    Scope *decls;
+
+
+    if (right == nullptr)
+	right = new Number(1, integer);
+
+    decls = nullptr;
+
+    if (!left->pure() && left->isDereference(pointer)) {
+	decls = new Scope();
+	symbol = new Symbol("compound.address", pointer->type());
+	decls->insert(symbol);
+
+	stmts.push_back(checkAssignment(new Identifier(symbol), pointer));
+	left = new Dereference(new Identifier(symbol), left->type());
+    }
+
+    value = left->clone(subst);
+
+    if (op == INC || op == ADD_ASSIGN)
+	value = checkAdd(value, right);
+    else if (op == DEC || op == SUB_ASSIGN)
+	value = checkSubtract(value, right);
+    else if (op == MUL_ASSIGN)
+	value = checkMultiply(value, right);
+    else if (op == DIV_ASSIGN)
+	value = checkDivide(value, right);
+    else if (op == REM_ASSIGN)
+	value = checkRemainder(value, right);
+    else if (op == AND_ASSIGN)
+	value = checkBitwiseAnd(value, right);
+    else if (op == XOR_ASSIGN)
+	value = checkBitwiseXor(value, right);
+    else if (op == OR_ASSIGN)
+	value = checkBitwiseOr(value, right);
+    else if (op == SHL_ASSIGN)
+	value = checkLeftShift(value, right);
+    else
+	value = checkRightShift(value, right);
+
+    if (decls == nullptr)
+	return checkAssignment(left, value);
+
+    stmts.push_back(checkAssignment(left, value));
+    return new Block(decls, stmts);
+}
+
+
 /*
  * Function:	checkReturn
  *
@@ -910,3 +1198,83 @@ void checkTest(Expression *&expr)
     if (t != error && !t.isPredicate())
 	report(invalid_test);
 }
+
+
+/*
+ * Function:	checkSwitch
+ *
+ * Description:	Check the expression of a switch statement: the type must
+ *		be numeric after promotion.
+ */
+
+void checkSwitch(Expression *&expr)
+{
+    const Type &t = promote(expr);
+
+    if (t != error && !t.isNumeric())
+	report(invalid_switch);
+}
+
+
+/*
+ * Function:	checkCase
+ *
+ * Description:	Check a case label within a switch statement whose
+ *		expression has the given type: the label must be a
+ *		constant, and its value once converted to that type must
+ *		not already be a case.  The label is recorded as starting
+ *		at the given statement.
+ */
+
+void checkCase(Expression *label, const Type &type, Cases &cases, unsigned index)
+{
+    long value;
+
+
+    if (label->type() == error || type == error)
+	return;
+
+    if (!label->type().isNumeric() || !label->constant(Constants(), value)) {
+	report(invalid_case);
+	return;
+    }
+
+    value = type.normalize(value);
+
+    if (cases.count(value) > 0)
+	report(duplicate_case);
+    else
+	cases[value] = index;
+}
+
+
+/*
+ * Function:	checkDefault
+ *
+ * Description:	Check a default label within a switch statement: there
+ *		must not already be one.  The label is recorded as
+ *		starting at the given statement.
+ */
+
+void checkDefault(bool seen, unsigned &dflt, unsigned index)
+{
+    if (seen)
+	report(duplicate_default);
+    else
+	dflt = index;
+}
+
+
+/*
+ * Function:	checkBreak
+ *
+ * Description:	Check a break statement: it must be within a switch
+ *		statement, and not within a loop within that switch, since
+ *		Simple C has no break from a loop.
+ */
+
+void checkBreak(bool inSwitch)
+{
+    if (!inSwitch)
+	report(invalid_break);
+}
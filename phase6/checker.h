@@ -22,6 +22,7 @@ Expression *checkCall(Symbol *symbol, Expressions &args);
 Expression *checkArray(Expression *left, Expression *right);
 Expression *checkNot(Expression *expr);
 Expression *checkNegate(Expression *expr);
+Expression *checkComplement(Expression *expr);
 Expression *checkDereference(Expression *expr);
 Expression *checkAddress(Expression *expr);
 Expression *checkSizeof(Expression *expr);
@@ -30,17 +31,27 @@ Expression *checkDivide(Expression *left, Expression *right);
 Expression *checkRemainder(Expression *left, Expression *right);
 Expression *checkAdd(Expression *left, Expression *right);
 Expression *checkSubtract(Expression *left, Expression *right);
+Expression *checkLeftShift(Expression *left, Expression *right);
+Expression *checkRightShift(Expression *left, Expression *right);
 Expression *checkLessThan(Expression *left, Expression *right);
 Expression *checkGreaterThan(Expression *left, Expression *right);
 Expression *checkLessOrEqual(Expression *left, Expression *right);
 Expression *checkGreaterOrEqual(Expression *left, Expression *right);
 Expression *checkEqual(Expression *left, Expression *right);
 Expression *checkNotEqual(Expression *left, Expression *right);
+Expression *checkBitwiseAnd(Expression *left, Expression *right);
+Expression *checkBitwiseXor(Expression *left, Expression *right);
+Expression *checkBitwiseOr(Expression *left, Expression *right);
 Expression *checkLogicalAnd(Expression *left, Expression *right);
 Expression *checkLogicalOr(Expression *left, Expression *right);
 Statement *checkAssignment(Expression *left, Expression *right);
+Statement *checkCompound(Expression *left, int op, Expression *right);
 
 void checkReturn(Expression *&expr, const Type &type);
 void checkTest(Expression *&expr);
+void checkSwitch(Expression *&expr);
+void checkCase(Expression *label, const Type &type, Cases &cases, unsigned index);
+void checkDefault(bool seen, unsigned &dflt, unsigned index);
+void checkBreak(bool inSwitch);
 
 # endif /* CHECKER_H */
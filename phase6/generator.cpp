@@ -6,23 +6,64 @@
  *
  *		Extra functionality:
  *		- putting all the global declarations at the end
+ *		- vectorizing simple counted loops using SSE2
+ *		- packing adjacent element-wise assignments using SSE2
+ *		- inlined function calls
+ *		- tail calls and tail recursion
+ *		- leaf functions without stack frames
+ *		- peephole optimization of each function
+ *		- reusing values held in registers
+ *		- reusing values across branches and loops
+ *		- eliminating dead code and dead stores
+ *		- propagating constants through local variables
+ *		- unrolling and unswitching loops
+ *		- threading jumps over branches with known outcomes
+ *		- conditional moves for simple if statements
+ *		- switch statements using jump tables, bit tests, and searches
+ *		- modifying variables and array elements in place
+ *		- unsigned division by powers of two using shifts and masks
+ *		- bitwise and shift operators
+ *		- omitting sign extensions of values known to be non-negative
+ *		- extending chars and ints as they are loaded
+ *		- aligning global variables
+ *		- mergeable string literals that share common suffixes
  */
 
+# include <algorithm>
 # include <vector>
 # include <cassert>
+# include <climits>
 # include <iostream>
+# include <sstream>
+# include <typeinfo>
 # include <map>
+# include <set>
 # include "generator.h"
 # include "machine.h"
 # include "Tree.h"
 # include "Label.h"
 # include "string.h"
+# include "options.h"
+# include "peephole.h"
+# include "alias.h"
+# include "tokens.h"
 
 using namespace std;
 
 static int offset;
 static string funcname;
+static const Symbol *function;
+static Inline *inlined;
+static const Label *inlinedExit;
+static bool inlinedTail, tail;
+static string suffix(unsigned long size);
 static string suffix(Expression *expr);
+static string extension(const Type &type, unsigned size, unsigned &width);
+static unsigned superword(const Statements &stmts, unsigned first);
+static unsigned thread(const Statements &stmts, unsigned first);
+static void iterate(Statement *init, Expression *expr, Statement *incr,
+		    Statement *stmt);
+static Statement *specialize(Statement *stmt);
 static ostream &operator <<(ostream &ostr, Expression *expr);
 
 static Register *rax = new Register("%rax", "%eax", "%al");
@@ -43,6 +84,20 @@ static Register *r15 = new Register("%r15", "%r15d", "%r15b");
 static vector<Register *> parameters = {rdi, rsi, rdx, rcx, r8, r9};
 static vector<Register *> registers = {rax, rdi, rsi, rdx, rcx, r8, r9, r10, r11};
 static map<string, Label> strings;
+static map<const If *, bool> specialized;
+
+struct State {
+    map<Register *, set<string>> values;
+    map<string, unsigned> versions;
+    map<string, long> facts;
+};
+
+static map<Register *, set<string>> values;
+static map<string, unsigned> versions;
+static map<string, long> facts;
+static map<string, Location> locations;
+static Ranges ranges;
+static unsigned generation;
 
 /* These will be replaced with functions in the next phase.  They are here
    as placeholders so that Call::generate() is finished. */
@@ -63,9 +118,19 @@ static void assign(Expression *expr, Register *reg)
             reg->_node->_register = nullptr;
         
         reg->_node = expr;
+
+        if (expr != nullptr && values[reg].count(expr->key()) == 0) {
+            values[reg].clear();
+
+            if (cse && !expr->key().empty())
+                values[reg].insert(expr->key());
+        }
     }
 }
 
+static Register *cached(Expression *expr);
+static Register *getreg(Expression *expr = nullptr);
+
 static void load(Expression *expr, Register *reg)
 {
     if (reg->_node != expr)
@@ -82,16 +147,41 @@ static void load(Expression *expr, Register *reg)
         if(expr != nullptr)
         {
             unsigned size = expr->type().size();
-            cout << "\tmov" << suffix(expr) << expr;
-            cout << ", " << reg->name(size) << endl;
+            unsigned width = max(size, (unsigned) SIZEOF_INT);
+            unsigned long value;
+            Register *source = nullptr;
+
+            if (expr->_register == nullptr)
+                source = cached(expr);
+
+            if (source == nullptr) {
+                if (expr->isNumber(value))
+                    cout << "\tmov" << suffix(width);
+                else
+                    cout << extension(expr->type(), size, width);
+
+                cout << expr << ", " << reg->name(width) << endl;
+            } else if (source != reg) {
+                cout << "\tmov" << suffix(width) << source->name(width);
+                cout << ", " << reg->name(width) << endl;
+            }
         }
 
         assign(expr, reg);
     }
 }
 
-static Register* getreg()
+static Register* getreg(Expression *expr)
 {
+    Register *reg;
+
+    if (expr != nullptr && (reg = cached(expr)) != nullptr && reg->_node == nullptr)
+        return reg;
+
+    for (auto reg : registers)
+        if (reg->_node == nullptr && values[reg].empty())
+            return reg;
+
     for(auto reg : registers)
     {
         if(reg->_node == nullptr)
@@ -101,662 +191,3937 @@ static Register* getreg()
     abort();
 }
 
+
 /*
- * Function:	suffix (private)
+ * Function:	forget (private)
  *
- * Description:	Return the suffix for an opcode based on the given size.
+ * Description:	Forget the values held in all registers.  This must be
+ *		done after every call, and at any label whose paths are not
+ *		all known, since the values may differ along each path.
  */
 
-static string suffix(unsigned long size)
+static void forget()
 {
-    return size == 1 ? "b\t" : (size == 4 ? "l\t" : "q\t");
+    values.clear();
 }
 
 
 /*
- * Function:	suffix (private)
+ * Function:	save (private)
  *
- * Description:	Return the suffix for an opcode based on the size of the
- *		given expression.
+ * Description:	Return the current state of the values held in registers,
+ *		of the versions on which they depend, and of the values of
+ *		any expressions known along the current path.
  */
 
-static string suffix(Expression *expr)
+static State save()
 {
-    return suffix(expr->type().size());
+    State state;
+
+
+    state.values = values;
+    state.versions = versions;
+    state.facts = facts;
+    return state;
 }
 
 
 /*
- * Function:	align (private)
+ * Function:	restore (private)
  *
- * Description:	Return the number of bytes necessary to align the given
- *		offset on the stack.
+ * Description:	Make the given state the current state.  This is done at
+ *		the start of each arm of an if statement, since the
+ *		registers hold the same values along both branches.
  */
 
-static int align(int offset)
+static void restore(const State &state)
 {
-    if (offset % STACK_ALIGNMENT == 0)
-	return 0;
-
-    return STACK_ALIGNMENT - (abs(offset) % STACK_ALIGNMENT);
+    values = state.values;
+    versions = state.versions;
+    facts = state.facts;
 }
 
 
 /*
- * Function:	operator << (private)
+ * Function:	meet (private)
  *
- * Description:	Convenience function for writing the operand of an
- *		expression using the output stream operator.
+ * Description:	Return the state at a point reached along two paths with
+ *		the given states.  A register holds only those values that
+ *		it holds along both paths.  A location changed along either
+ *		path receives a new version, since its value depends on the
+ *		path taken.  An expression is known only if it has the
+ *		same value along both paths.
  */
 
-static ostream &operator <<(ostream &ostr, Expression *expr)
+static State meet(const State &first, const State &second)
 {
-    if (expr->_register != nullptr)
-	return ostr << expr->_register;
+    State state;
+    set<string> names;
 
-    expr->operand(ostr);
-    return ostr;
+
+    for (auto reg : registers) {
+	auto a = first.values.find(reg), b = second.values.find(reg);
+
+	if (a != first.values.end() && b != second.values.end())
+	    for (auto &key : a->second)
+		if (b->second.count(key) > 0)
+		    state.values[reg].insert(key);
+    }
+
+    for (auto &entry : first.versions)
+	names.insert(entry.first);
+
+    for (auto &entry : second.versions)
+	names.insert(entry.first);
+
+    for (auto &name : names) {
+	auto a = first.versions.find(name), b = second.versions.find(name);
+	unsigned x = (a != first.versions.end() ? a->second : 0);
+	unsigned y = (b != second.versions.end() ? b->second : 0);
+
+	state.versions[name] = (x == y ? x : ++ generation);
+    }
+
+    for (auto &entry : first.facts) {
+	auto b = second.facts.find(entry.first);
+
+	if (b != second.facts.end() && b->second == entry.second)
+	    state.facts.insert(entry);
+    }
+
+    return state;
 }
 
 
 /*
- * Function:	Expression::operand
+ * Function:	holds (private)
  *
- * Description:	Write an expression as an operand to the specified stream.
+ * Description:	Return whether every value held in a register in the
+ *		first state is also held by that register in the second.
  */
 
-void Expression::operand(ostream &ostr) const
+static bool holds(const State &first, const State &second)
 {
-    assert(_offset != 0);
-    ostr << _offset << "(%rbp)";
+    for (auto &entry : first.values)
+	for (auto &key : entry.second) {
+	    auto b = second.values.find(entry.first);
+
+	    if (b == second.values.end() || b->second.count(key) == 0)
+		return false;
+	}
+
+    return true;
 }
 
 
 /*
- * Function:	Identifier::operand
+ * Function:	version (private)
  *
- * Description:	Write an identifier as an operand to the specified stream.
+ * Description:	Return the version of the given location, which changes
+ *		whenever the location may be written.  The location is
+ *		noted so that any later store that may alias it gives it a
+ *		new version.
  */
 
-void Identifier::operand(ostream &ostr) const
+static unsigned version(const Location &location)
 {
-    if (_symbol->_offset == 0)
-	ostr << global_prefix << _symbol->name() << global_suffix;
-    else
-	ostr << _symbol->_offset << "(%rbp)";
+    locations.insert(make_pair(location.name(), location));
+    return versions[location.name()];
 }
 
 
 /*
- * Function:	Number::operand
+ * Function:	clobber (private)
  *
- * Description:	Write a number as an operand to the specified stream.
+ * Description:	Give a new version to every location that may be changed
+ *		by a store to the given location, or by a call if no
+ *		location is given.
  */
 
-void Number::operand(ostream &ostr) const
+static void clobber(const Location &location)
 {
-    ostr << "$" << _value;
+    locations.insert(make_pair(location.name(), location));
+
+    for (auto &entry : locations)
+	if (entry.second.mayAlias(location))
+	    versions[entry.first] = ++ generation;
+}
+
+static void clobber()
+{
+    for (auto &entry : locations)
+	if (entry.second.escapes())
+	    versions[entry.first] = ++ generation;
 }
 
 
 /*
- * Function:	Call::generate
- *
- * Description:	Generate code for a function call expression.
- *
- *		On a 64-bit platform, the stack needs to be aligned on a
- *		16-byte boundary.  So, if the stack will not be aligned
- *		after pushing any arguments, we first adjust the stack
- *		pointer.
- *
- *		Since all arguments are 8-bytes wide, we could simply do:
+ * Function:	evaluate (private)
  *
- *		    if (args.size() > 6 && args.size() % 2 != 0)
- *			subq $8, %rsp
+ * Description:	Return whether the value of the given expression is known
+ *		along the current path, and if so its value.  Since the
+ *		keys are versioned, a fact about an expression is simply
+ *		never found again once any location it depends on changes.
  */
 
-void Call::generate()
+static bool evaluate(Expression *expr, long &value)
 {
-    unsigned numBytes;
+    unsigned long number;
+    Cast *cast;
+    string key;
 
 
-    /* Generate code for the arguments first. */ 
+    if (expr->isNumber(number)) {
+	value = number;
+	return true;
+    }
 
-    numBytes = 0;
+    key = expr->key();
+    auto entry = facts.find(key);
 
-    for (int i = _args.size() - 1; i >= 0; i --)
-	_args[i]->generate();
+    if (!key.empty() && entry != facts.end()) {
+	value = entry->second;
+	return true;
+    }
 
+    if ((cast = dynamic_cast<Cast *>(expr)) != nullptr)
+	if (cast->type().isNumeric() && cast->expr()->type().isNumeric())
+	    if (evaluate(cast->expr(), value)) {
+		value = cast->type().normalize(value);
+		return true;
+	    }
 
-    /* Adjust the stack if necessary */
+    return false;
+}
 
-    if (_args.size() > NUM_PARAM_REGS) {
-	numBytes = align((_args.size() - NUM_PARAM_REGS) * SIZEOF_PARAM);
 
-	if (numBytes > 0)
-	    cout << "\tsubq\t$" << numBytes << ", %rsp" << endl;
-    }
+/*
+ * Function:	decide (private)
+ *
+ * Description:	Return whether the outcome of the given test is known along
+ *		the current path, and if so whether it is true.  A test is
+ *		known if its own value is known, if it is the negation of a
+ *		known test, or if it compares two known values.  A test
+ *		with a known outcome has no effects, since its key would
+ *		otherwise be empty.  Unsigned values are compared after
+ *		flipping their sign bits, which orders them as signed
+ *		values.
+ */
 
+static bool decide(Expression *expr, bool &truth)
+{
+    Binary *binary;
+    Not *negation;
+    long value, left, right;
 
-    /* Move the arguments into the correct registers or memory locations. */
 
-    for (int i = _args.size() - 1; i >= 0; i --) {
-	if (i >= NUM_PARAM_REGS) {
-	    numBytes += SIZEOF_PARAM;
-	    load(_args[i], rax);
-	    cout << "\tpushq\t%rax" << endl;
+    if (evaluate(expr, value)) {
+	truth = value != 0;
+	return true;
+    }
 
-	} else
-	    load(_args[i], parameters[i]);
+    if ((negation = dynamic_cast<Not *>(expr)) != nullptr) {
+	if (!decide(negation->expr(), truth))
+	    return false;
 
-	assign(_args[i], nullptr);
+	truth = !truth;
+	return true;
     }
 
+    Not complement(expr, Type(INT));
 
-    /* Call the function and then reclaim the stack space.  Technically, we
-       only need to assign the number of floating point arguments passed in
-       vector registers to %eax if the function being called takes a
-       variable number of arguments.  But, it never hurts. */
+    if (!expr->key().empty() && evaluate(&complement, value)) {
+	truth = value == 0;
+	return true;
+    }
 
-    for (auto reg : registers)
-	load(nullptr, reg);
+    if ((binary = dynamic_cast<Binary *>(expr)) == nullptr)
+	return false;
 
-    if (_id->type().parameters() == nullptr)
-	cout << "\tmovl\t$0, %eax" << endl;
+    if (!binary->left()->type().isNumeric())
+	return false;
 
-    cout << "\tcall\t" << global_prefix << _id->name() << endl;
+    if (!evaluate(binary->left(), left) || !evaluate(binary->right(), right))
+	return false;
 
-    if (numBytes > 0)
-	cout << "\taddq\t$" << numBytes << ", %rsp" << endl;
+    if (binary->left()->type().isUnsigned()) {
+	left ^= LONG_MIN;
+	right ^= LONG_MIN;
+    }
 
-    assign(this, rax);
+    if (dynamic_cast<LessThan *>(expr) != nullptr)
+	truth = left < right;
+    else if (dynamic_cast<GreaterThan *>(expr) != nullptr)
+	truth = left > right;
+    else if (dynamic_cast<LessOrEqual *>(expr) != nullptr)
+	truth = left <= right;
+    else if (dynamic_cast<GreaterOrEqual *>(expr) != nullptr)
+	truth = left >= right;
+    else if (dynamic_cast<Equal *>(expr) != nullptr)
+	truth = left == right;
+    else if (dynamic_cast<NotEqual *>(expr) != nullptr)
+	truth = left != right;
+    else
+	return false;
+
+    return true;
 }
 
 
 /*
- * Function:	Block::generate
+ * Function:	assume (private)
  *
- * Description:	Generate code for this block, which simply means we
- *		generate code for each statement within the block.
+ * Description:	Record the facts that follow from the given test having
+ *		the given outcome.  A comparison or negation is then known
+ *		to be one or zero, and any other test is known to be zero
+ *		if false, or to have a zero negation if true.  An equality
+ *		test against a number gives the value of its left operand,
+ *		and the operands of a logical operator are known if the
+ *		operator alone determines them.
  */
 
-void Block::generate()
+static void assume(Expression *expr, bool truth)
 {
-    for (auto stmt : _stmts) {
-	stmt->generate();
+    Binary *binary;
+    Not *negation;
+    unsigned long number;
+    string key;
+
+
+    binary = dynamic_cast<Binary *>(expr);
+    negation = dynamic_cast<Not *>(expr);
+
+    if (negation != nullptr)
+	assume(negation->expr(), !truth);
+    else if (dynamic_cast<LogicalAnd *>(expr) != nullptr && truth) {
+	assume(binary->left(), true);
+	assume(binary->right(), true);
+    } else if (dynamic_cast<LogicalOr *>(expr) != nullptr && !truth) {
+	assume(binary->left(), false);
+	assume(binary->right(), false);
+    }
 
-	for (auto reg : registers)
-	    assert(reg->_node == nullptr);
+    if ((key = expr->key()).empty())
+	return;
+
+    if (negation != nullptr || dynamic_cast<LessThan *>(expr) != nullptr ||
+	dynamic_cast<GreaterThan *>(expr) != nullptr ||
+	dynamic_cast<LessOrEqual *>(expr) != nullptr ||
+	dynamic_cast<GreaterOrEqual *>(expr) != nullptr ||
+	dynamic_cast<Equal *>(expr) != nullptr ||
+	dynamic_cast<NotEqual *>(expr) != nullptr)
+	facts[key] = truth;
+    else if (!truth)
+	facts[key] = 0;
+    else {
+	Not complement(expr, Type(INT));
+	facts[complement.key()] = 0;
     }
+
+    if (dynamic_cast<Equal *>(expr) != nullptr ? truth :
+	dynamic_cast<NotEqual *>(expr) != nullptr && !truth)
+	if (binary->right()->isNumber(number))
+	    if (!(key = binary->left()->key()).empty())
+		facts[key] = binary->left()->type().normalize(number);
 }
 
 
 /*
- * Function:	Simple::generate
+ * Function:	cached (private)
  *
- * Description:	Generate code for a simple (expression) statement, which
- *		means simply generating code for the expression.
+ * Description:	Return a register known to hold the value of the given
+ *		expression, preferring one that is not in use, or a null
+ *		pointer if there is none.
  */
 
-void Simple::generate()
+static Register *cached(Expression *expr)
 {
-    _expr->generate();
-    assign(_expr, nullptr);
-}
+    Register *found = nullptr;
+    string key;
 
 
-/*
- * Function:	Function::generate
- *
- * Description:	Generate code for this function, which entails allocating
- *		space for local variables, then emitting our prologue, the
- *		body of the function, and the epilogue.
- */
-
-void Function::generate()
-{
-    int param_offset;
-    unsigned size;
-    Parameters *params;
-    Symbols symbols;
+    if (!cse || (key = expr->key()).empty())
+	return nullptr;
 
+    for (auto reg : registers)
+	if (values[reg].count(key) > 0) {
+	    if (reg->_node == nullptr)
+		return reg;
 
-    /* Assign offsets to the parameters and local variables. */
+	    found = reg;
+	}
 
-    param_offset = 2 * SIZEOF_REG;
-    offset = param_offset;
-    allocate(offset);
+    return found;
+}
 
 
-    /* Generate our prologue. */
+/*
+ * Function:	reuse (private)
+ *
+ * Description:	Attempt to reuse the value of the given expression from a
+ *		register rather than recomputing it, and return whether we
+ *		were successful.  If the register is in use, then its value
+ *		is copied to a free register.
+ */
 
-    funcname = _id->name();
-    cout << global_prefix << funcname << ":" << endl;
-    cout << "\tpushq\t%rbp" << endl;
-    cout << "\tmovq\t%rsp, %rbp" << endl;
-    cout << "\tmovl\t$" << funcname << ".size, %eax" << endl;
-    cout << "\tsubq\t%rax, %rsp" << endl;
+static bool reuse(Expression *expr)
+{
+    Register *reg, *copy;
 
 
-    /* Spill any parameters. */
+    if ((reg = cached(expr)) == nullptr)
+	return false;
 
-    params = _id->type().parameters();
-    symbols = _body->declarations()->symbols();
+    if (reg->_node != nullptr) {
+	copy = nullptr;
 
-    for (unsigned i = 0; i < NUM_PARAM_REGS; i ++)
-	if (i < params->size()) {
-	    size = symbols[i]->type().size();
-	    cout << "\tmov" << suffix(size) << parameters[i]->name(size);
-	    cout << ", " << symbols[i]->_offset << "(%rbp)" << endl;
-	} else
-	    break;
+	for (auto free : registers)
+	    if (free->_node == nullptr) {
+		copy = free;
+		break;
+	    }
 
+	if (copy == nullptr)
+	    return false;
 
-    /* Generate the body of this function. */
+	cout << "\tmovq\t" << reg->name() << ", " << copy->name() << endl;
+	reg = copy;
+    }
 
-    _body->generate();
+    assign(expr, reg);
+    return true;
+}
 
+/*
+ * Function:	fetch (private)
+ *
+ * Description:	Use a register known to hold the value of the given
+ *		operand, if there is one that is not in use, rather than
+ *		reading the operand from memory.
+ */
 
-    /* Generate our epilogue. */
+static void fetch(Expression *expr)
+{
+    Register *reg;
 
-    cout << endl << global_prefix << funcname << ".exit:" << endl;
-    cout << "\tmovq\t%rbp, %rsp" << endl;
-    cout << "\tpopq\t%rbp" << endl;
-    cout << "\tret" << endl << endl;
 
-    offset -= align(offset - param_offset);
-    cout << "\t.set\t" << funcname << ".size, " << -offset << endl;
-    cout << "\t.globl\t" << global_prefix << funcname << endl << endl;
+    if (expr->_register == nullptr && (reg = cached(expr)) != nullptr)
+	if (reg->_node == nullptr)
+	    assign(expr, reg);
 }
 
-
 /*
- * Function:	generateGlobals
+ * Function:	suffix (private)
  *
- * Description:	Generate code for any global variable declarations.
+ * Description:	Return the suffix for an opcode based on the given size.
  */
 
-void generateGlobals(Scope *scope)
+static string suffix(unsigned long size)
 {
-    const Symbols &symbols = scope->symbols();
-
-    for (auto symbol : symbols)
-	if (!symbol->type().isFunction()) {
-	    cout << "\t.comm\t" << global_prefix << symbol->name() << ", ";
-	    cout << symbol->type().size() << endl;
-	}
-
-    if (strings.size() > 0){
-        cout << "\t.data\n";
-        for (auto str : strings)
-            cout << str.second << ":\t.asciz\t\"" << escapeString(str.first) << "\"\n";
-    }
+    return size == 1 ? "b\t" : (size == 4 ? "l\t" : "q\t");
 }
 
 
 /*
- * Function:	Assignment::generate
- *
- * Description:	Generate code for an assignment statement.
+ * Function:	suffix (private)
  *
- *		NOT FINISHED: Only works if the right-hand side is an
- *		integer literal and the left-hand side is an integer
- *		scalar.
+ * Description:	Return the suffix for an opcode based on the size of the
+ *		given expression.
  */
 
-void Assignment::generate()
+static string suffix(Expression *expr)
 {
-    Expression * pointer;
+    return suffix(expr->type().size());
+}
 
-    _right->generate();
-    // assert(dynamic_cast<Number *>(_right));
-    // assert(dynamic_cast<Identifier *>(_left));
 
-    if(_left->isDereference(pointer))
-    {
-        pointer->generate();
+/*
+ * Function:	extension (private)
+ *
+ * Description:	Return the opcode for loading an operand of the given type
+ *		from memory and extending it to the given size, along with
+ *		the width of the register written.  A char is always
+ *		extended to at least a double word, since writing just the
+ *		low byte of a register must merge with its old contents.
+ */
 
-        if(pointer->_register == nullptr)
-            load(pointer, getreg());
+static string extension(const Type &type, unsigned size, unsigned &width)
+{
+    bool sign = !type.isUnsigned();
 
-        if  (_right->_register == nullptr)
-            load(_right, getreg());
 
-        cout << "\tmov" << suffix(_left) << _right << ", (" << pointer << ")\n";
+    width = SIZEOF_INT;
 
-        assign(pointer, nullptr);
-    }
-    else{
-        unsigned long val;
-        if(!_right->isNumber(val))
-        {
-                load(_right, getreg());
-        }
-        
-        cout << "\tmov" << suffix(_right) << _right;
-        cout << ", " << _left << endl;
+    if (type.size() == 1 && sign && size == SIZEOF_LONG) {
+	width = SIZEOF_LONG;
+	return "\tmovsbq\t";
     }
-    assign(_right, nullptr);
-}
 
-/* Add, mul, sub  computation */
-static void compute(Expression* result, Expression* left, Expression* right, const string& opcode)
-{
-    left->generate();
-    right->generate();
+    if (type.size() == 1)
+	return sign ? "\tmovsbl\t" : "\tmovzbl\t";
 
-    if(left->_register == nullptr){
-        load(left, getreg());
+    if (type.size() < size && sign) {
+	width = SIZEOF_LONG;
+	return "\tmovslq\t";
     }
 
-    cout << "\t" << opcode << suffix(result) << right;
-    cout << ", " << left << endl;
-
-    assign(right, nullptr);
-    assign(result, left->_register);
+    width = type.size();
+    return "\tmov" + suffix(width);
 }
 
-void Add::generate()
-{
-    compute(this, _left, _right, "add");
-}
 
-void Subtract::generate()
-{
-    compute(this, _left, _right, "sub");
-}
+/*
+ * Function:	align (private)
+ *
+ * Description:	Return the number of bytes necessary to align the given
+ *		offset on the stack.
+ */
 
-void Multiply::generate()
+static int align(int offset)
 {
-    compute(this, _left, _right, "imul");
+    if (offset % STACK_ALIGNMENT == 0)
+	return 0;
+
+    return STACK_ALIGNMENT - (abs(offset) % STACK_ALIGNMENT);
 }
 
-/* Div and Rem compuation */
-static void computeDiv(Expression* result, Expression* left, Expression* right, const string& op)
-{
-    left->generate();
-    right->generate();
 
-    load(left, rax);
-    load(nullptr, rdx);
-    load(right, rcx);
+/*
+ * Function:	operator << (private)
+ *
+ * Description:	Convenience function for writing the operand of an
+ *		expression using the output stream operator.
+ */
 
-    if(result->type().size() == 4)
-        cout << "\tcltd\n";
-    else
-        cout << "\tcqto\n";
+static ostream &operator <<(ostream &ostr, Expression *expr)
+{
+    if (expr->_register != nullptr)
+	return ostr << expr->_register;
 
-    cout << "\tidiv" << suffix(result) << right << endl;
+    expr->operand(ostr);
+    return ostr;
+}
 
-    assign(left, nullptr);
-    assign(right, nullptr);
 
-    if(op == "div")
-        assign(result, rax);
-    else
-        assign(result, rdx);
+/*
+ * Function:	Expression::operand
+ *
+ * Description:	Write an expression as an operand to the specified stream.
+ */
+
+void Expression::operand(ostream &ostr) const
+{
+    assert(_offset != 0);
+    ostr << _offset << "(%rbp)";
 }
 
 
-void Divide::generate()
+/*
+ * Function:	Identifier::operand
+ *
+ * Description:	Write an identifier as an operand to the specified stream.
+ */
+
+void Identifier::operand(ostream &ostr) const
 {
-    computeDiv(this, _left, _right, "div");
+    if (_symbol->_offset == 0)
+	ostr << global_prefix << _symbol->name() << global_suffix;
+    else
+	ostr << _symbol->_offset << "(%rbp)";
 }
 
-void Remainder::generate()
+
+/*
+ * Function:	Number::operand
+ *
+ * Description:	Write a number as an operand to the specified stream.
+ */
+
+void Number::operand(ostream &ostr) const
 {
-    computeDiv(this, _left, _right, "rem");
+    ostr << "$" << _value;
 }
 
-/* Relational and Equality Operators */
-static void computeComp(Expression* result, Expression* left, Expression* right, const string& op)
-{
-    left->generate();
-    right->generate();
 
-    if(left->_register == nullptr)
-        load(left, getreg());
-    cout << "\tcmp" << suffix(left) << right << ", " << left->_register << endl;
+/*
+ * Function:	Number::generate
+ *
+ * Description:	Generate code for a number, which is normally written as
+ *		an immediate operand.  A long that doesn't fit in one, such
+ *		as a large unsigned value, must first be loaded into a
+ *		register.
+ */
 
-    assign(left, nullptr);
-    assign(right, nullptr);
+void Number::generate()
+{
+    unsigned long value;
 
-    assign(result, getreg());
 
-    cout << "\tset" << op << "\t" << result->_register->byte() << endl;
-    cout << "\tmovzbl\t" << result->_register->byte() << ", " << result->_register->name(4) << endl;
+    isNumber(value);
+
+    if (_register == nullptr && (long) value != (int) value)
+	if (_type.size() == SIZEOF_LONG)
+	    load(this, getreg());
 }
 
-void LessThan::generate()
+
+/*
+ * Function:	Expression::key
+ *
+ * Description:	Return the key used to number the value of an expression.
+ *		Two expressions with the same key are known to have the
+ *		same value.  An empty key means that the expression is not
+ *		numbered, such as if it has side effects or contains
+ *		branches.
+ *
+ *		The key of a variable or a dereference includes the
+ *		version of the location accessed, which changes whenever
+ *		the location may be written, whether directly, through a
+ *		pointer that may alias it, or by a call.
+ */
+
+string Expression::key() const
 {
-    computeComp(this, _left, _right, "l");
+    return "";
 }
 
-void GreaterThan::generate()
+
+/*
+ * The remaining key functions aren't very interesting.  The class of each
+ * operator is distinguished using its type information.
+ */
+
+string Identifier::key() const
 {
-    computeComp(this, _left, _right, "g");
+    ostringstream ostr;
+
+    Location location(this);
+
+    ostr << location.name() << "." << version(location) << ":" << _type.size();
+    return ostr.str();
 }
 
-void LessOrEqual::generate()
+string Number::key() const
 {
-    computeComp(this, _left, _right, "le");
+    ostringstream ostr;
+
+    ostr << "$" << _value << ":" << _type.size();
+    return ostr.str();
 }
 
-void GreaterOrEqual::generate()
+string Unary::key() const
 {
-    computeComp(this, _left, _right, "ge");
+    ostringstream ostr;
+    string expr = _expr->key();
+
+    if (expr.empty())
+	return "";
+
+    ostr << "(" << typeid(*this).name() << " " << expr << "):" << _type.size();
+    return ostr.str();
 }
 
-void Equal::generate()
+string Binary::key() const
 {
-    computeComp(this, _left, _right, "e");
+    ostringstream ostr;
+    string left = _left->key(), right = _right->key();
+
+    if (left.empty() || right.empty())
+	return "";
+
+    ostr << "(" << typeid(*this).name() << " " << left << " " << right << ")";
+    ostr << ":" << _type.size();
+    return ostr.str();
 }
 
-void NotEqual::generate()
+string Dereference::key() const
 {
-    computeComp(this, _left, _right, "ne");
+    ostringstream ostr;
+    string expr = Unary::key();
+
+    if (expr.empty())
+	return "";
+
+    ostr << expr << "@" << version(Location(this));
+    return ostr.str();
 }
 
-/* unary not and neg */
-void Not::generate()
+string Address::key() const
 {
-    _expr->generate();
+    ostringstream ostr;
+    const Symbol *symbol;
 
-    if(_expr->_register == nullptr)
-        load(_expr, getreg());
+    if (!_expr->isIdentifier(symbol))
+	return Unary::key();
 
-    cout << "\tcmp" << suffix(_expr) << "$0, " << _expr << endl;
-    cout << "\tsete\t" << _expr->_register->byte() << endl;
-    cout << "\tmovzbl\t" << _expr->_register->byte() << ", " << _expr->_register << endl;
+    ostr << "&" << symbol;
+    return ostr.str();
+}
 
-    assign(this, _expr->_register);
+string LogicalAnd::key() const
+{
+    return "";
 }
 
-void Negate::generate()
+string LogicalOr::key() const
 {
-    _expr->generate();
-    if(_expr->_register == nullptr)
-        load(_expr, getreg());
+    return "";
+}
 
-    cout << "\tneg" <<  suffix(_expr) << _expr->_register << endl;
 
-    assign(this, _expr->_register);
-}
+/*
+ * Function:	Call::generate
+ *
+ * Description:	Generate code for a function call expression.
+ *
+ *		Space for any arguments passed on the stack is allocated
+ *		once at the bottom of our frame, which is already aligned
+ *		on a 16-byte boundary, so each such argument is simply
+ *		stored at a fixed offset from the stack pointer, and the
+ *		stack pointer is never adjusted.  A small constant is
+ *		stored directly.
+ */
 
+void Call::generate()
+{
+    unsigned long value;
+    int slot;
 
-void Expression::test(const Label& label, bool ifTrue){
-    generate();
 
-    if(_register == nullptr)
-        load(this, getreg());
+    /* Generate code for the arguments first. */ 
 
-    cout << "\tcmp" << suffix(this) << "$0, " << this << endl;
-    cout << (ifTrue ? "\tjne\t" : "\tje\t") << label << endl;
+    for (int i = _args.size() - 1; i >= 0; i --)
+	_args[i]->generate();
 
-    assign(this, nullptr);
-}
 
-void While::generate()
-{
-    cout << "# while" <<endl;
-    Label loop, exit;
-    cout << loop << ":" << endl;
+    /* Move the arguments into the correct registers or memory locations. */
 
-    _expr->test(exit, false);
-    _stmt->generate();
+    for (int i = _args.size() - 1; i >= 0; i --) {
+	if (i >= NUM_PARAM_REGS) {
+	    slot = (i - NUM_PARAM_REGS) * SIZEOF_PARAM;
 
-    cout << "\tjmp\t" << loop << endl;
-    cout << exit << ":" << endl;
-}
+	    if (_args[i]->isNumber(value) && (long) value == (int) value)
+		cout << "\tmovq\t" << _args[i];
+	    else {
+		if (_args[i]->_register == nullptr)
+		    load(_args[i], getreg(_args[i]));
 
-void Address::generate(){
+		cout << "\tmovq\t" << _args[i]->_register->name();
+	    }
 
-    Expression *pointer;
+	    cout << ", " << slot << "(%rsp)" << endl;
 
-    if(_expr->isDereference(pointer)) {
-        pointer->generate();
+	} else
+	    load(_args[i], parameters[i]);
 
-        if(pointer->_register == nullptr)
-            load(pointer, getreg());
-        
-        assign(this, pointer->_register);
-    }
-    else {
-        assign(this, getreg());
-        cout << "\tleaq\t" << _expr << ", " << this <<endl;
+	assign(_args[i], nullptr);
     }
-}
 
-void Dereference::generate(){
-    _expr -> generate();
 
-    if(_expr->_register == nullptr)
-        load(_expr, getreg());
-    
-    cout << "\tmov" << suffix(this->type().size()) << "(" << _expr << "), " << _expr->_register->name(this->type().size()) <<endl;
+    /* Call the function.  Technically, we only need to assign the number
+       of floating point arguments passed in vector registers to %eax if
+       the function being called takes a variable number of arguments.
+       But, it never hurts. */
 
-    assign(this, _expr->_register);
+    for (auto reg : registers)
+	load(nullptr, reg);
+
+    if (_id->type().parameters() == nullptr)
+	cout << "\tmovl\t$0, %eax" << endl;
+
+    cout << "\tcall\t" << global_prefix << _id->name() << endl;
+    forget();
+    clobber();
+    assign(this, rax);
 }
 
-void String::operand(ostream &ostr) const{
 
-    auto val = strings.find(value());
+/*
+ * Function:	Call::generateTail
+ *
+ * Description:	Attempt to generate code for a function call as the
+ *		expression of a return statement, and return whether we
+ *		were successful.  Rather than calling the function and then
+ *		returning its result, we discard our frame and jump to the
+ *		function, which then returns directly to our caller.  A
+ *		call to ourself simply reassigns the parameters and jumps
+ *		back to our entry.
+ *
+ *		Since our frame is discarded, a tail call is not possible
+ *		if the address of any local variable has been taken.  Any
+ *		arguments passed on the stack must also fit in the area
+ *		used by our own incoming arguments, which they replace.
+ *		Since they may be computed from our own arguments, they are
+ *		first copied to temporaries.
+ */
 
-    if (val == strings.end()){
-        auto label = strings.insert({value(), Label()});
-        ostr << label.first->second;
-    }
-    else{
-        ostr << val->second;
-    }
-}
+bool Call::generateTail()
+{
+    unsigned incoming, outgoing, i;
+    vector<int> temps;
 
-void Return::generate(){
-    _expr->generate();
 
-    load(_expr, rax);
+    incoming = function->type().parameters()->size();
+    outgoing = _args.size();
 
-    cout << "\tjmp\t" << funcname << ".exit\n";
+    if (function->_addressed)
+	return false;
 
-    assign(_expr, nullptr);
-}
+    if (outgoing > NUM_PARAM_REGS && outgoing > incoming)
+	return false;
 
-void Cast::generate(){
-    Register* reg;
-    unsigned source, target;
 
-    source = _expr->type().size();
-    target = _type.size();
+    /* Generate code for the arguments and copy any stack arguments. */
 
-    _expr->generate();
+    for (i = outgoing; i > 0; i --)
+	_args[i - 1]->generate();
 
-    if(source >= target)
-    {
-        load(_expr, getreg());
-        assign(this, _expr->_register);
+    for (i = NUM_PARAM_REGS; i < outgoing; i ++) {
+	load(_args[i], rax);
+	offset -= SIZEOF_PARAM;
+	temps.push_back(offset);
+	cout << "\tmovq\t%rax, " << offset << "(%rbp)" << endl;
+	assign(_args[i], nullptr);
     }
-    else {
 
-        if(_expr->_register == nullptr)
-            load(_expr, getreg());
 
-        if(source == 1 &&  target == 4){
-            cout << "\tmovsbl\t" << _expr->_register << ", " << _expr->_register->name(target) << endl;
-        }
-        else if(source == 1 && target == 8){
-            cout << "\tmovsbq\t" << _expr->_register << ", " << _expr->_register->name(target) << endl;
-        }
-        else{
-            cout << "\tmovslq\t" << _expr->_register << ", " << _expr->_register->name(target) << endl;
-        }
 
-        assign(this, _expr->_register);
-    }
-}
+    /* Move the remaining arguments into the correct registers before
+       overwriting our incoming arguments with the stack arguments. */
 
-void LogicalOr::generate(){
-    cout << "# or" <<endl;
-    auto success = Label();
-    auto exit = Label();
+    for (i = min(outgoing, (unsigned) NUM_PARAM_REGS); i > 0; i --)
+	load(_args[i - 1], parameters[i - 1]);
 
-    assign(this, getreg());
+    for (i = 0; i < outgoing && i < NUM_PARAM_REGS; i ++)
+	assign(_args[i], nullptr);
 
-    _left->test(success, true);
-    _right->test(success, true);
+    for (i = 0; i < temps.size(); i ++) {
+	cout << "\tmovq\t" << temps[i] << "(%rbp), %rax" << endl;
+	cout << "\tmovq\t%rax, " << 2 * SIZEOF_REG + i * SIZEOF_PARAM;
+	cout << "(%rbp)" << endl;
+    }
 
-    cout << "\tmov" << suffix(this) << "$0, " << this << endl;
-    cout << "\tjmp\t" << exit << endl;
-    cout << success << ":\n" << "\tmov" << suffix(this) << "$1, " << this << endl;
-    cout << exit << ":\n";
-}
 
-void LogicalAnd::generate(){
-    auto success = Label();
-    auto exit = Label();
+    /* Jump back to our entry or discard our frame and jump to the
+       function. */
 
-    assign(this, getreg());
+    if (_id == function) {
+	cout << "\tjmp\t" << global_prefix << funcname << ".entry" << endl;
+	return true;
+    }
 
-    _left->test(exit, false);
-    _right->test(exit, false);
-    cout << "\tmov" << suffix(this) << "$1, " << this << endl;
-    cout << "\tjmp\t" << success << endl;
+    if (_id->type().parameters() == nullptr)
+	cout << "\tmovl\t$0, %eax" << endl;
 
-    cout << exit << ":\n" << "\tmov" << suffix(this) << "$0, " << this << endl;
-    cout << success << ":\n";
+    cout << "\tmovq\t%rbp, %rsp" << endl;
+    cout << "\tpopq\t%rbp" << endl;
+    cout << "\tjmp\t" << global_prefix << _id->name() << endl;
+    return true;
 }
 
+
+/*
+ * Function:	Inline::operand
+ *
+ * Description:	Write an inlined call as an operand to the specified
+ *		stream, which is the local variable holding its result.
+ */
+
+void Inline::operand(ostream &ostr) const
+{
+    assert(_result != nullptr);
+    ostr << _result->_offset << "(%rbp)";
+}
+
+
+/*
+ * Function:	Inline::generate
+ *
+ * Description:	Generate code for an inlined call.  Any values still in
+ *		registers are spilled first, just as for a real call, since
+ *		the body may contain branches.  Any return within the body
+ *		stores its value in the result and jumps to the end, and so
+ *		the value of this expression is left in memory.  If we are
+ *		being returned directly, then a return within the body is
+ *		also a return from the function, and so may be a tail call.
+ */
+
+void Inline::generate()
+{
+    Inline *savedInlined;
+    const Label *savedExit;
+    bool savedTail;
+    Label exit;
+
+
+    for (auto reg : registers)
+	load(nullptr, reg);
+
+    savedInlined = inlined;
+    savedExit = inlinedExit;
+    savedTail = inlinedTail;
+    inlined = this;
+    inlinedExit = &exit;
+    inlinedTail = tail;
+    tail = false;
+
+    cout << "# inline " << _id->name() << endl;
+    _body->generate();
+    cout << exit << ":" << endl;
+    forget();
+    facts.clear();
+
+    inlined = savedInlined;
+    inlinedExit = savedExit;
+    inlinedTail = savedTail;
+}
+
+
+/*
+ * Function:	Block::generate
+ *
+ * Description:	Generate code for this block, which simply means we
+ *		generate code for each statement within the block, unless
+ *		a run of statements can be packed into vector operations,
+ *		or threaded through the branches of an if statement.  Any
+ *		statements after one that returns are unreachable.
+ */
+
+void Block::generate()
+{
+    unsigned i, count;
+
+
+    for (i = 0; i < _stmts.size(); i += count) {
+	if ((count = superword(_stmts, i)) > 0) {
+	    forget();
+	    clobber();
+	} else if ((count = thread(_stmts, i)) == 0) {
+	    _stmts[i]->generate();
+	    count = 1;
+	}
+
+	for (auto reg : registers)
+	    assert(reg->_node == nullptr);
+
+	if (dce && _stmts[i + count - 1]->returns())
+	    break;
+    }
+}
+
+
+/*
+ * Function:	Simple::generate
+ *
+ * Description:	Generate code for a simple (expression) statement, which
+ *		means simply generating code for the expression, unless
+ *		its value is unused and it has no other effect.
+ */
+
+void Simple::generate()
+{
+    if (dce && _expr->pure())
+	return;
+
+    _expr->generate();
+    assign(_expr, nullptr);
+}
+
+
+/*
+ * Function:	Function::generate
+ *
+ * Description:	Generate code for this function, which entails allocating
+ *		space for local variables, then emitting our prologue, the
+ *		body of the function, and the epilogue.
+ *
+ *		Since temporaries are allocated as the body is generated,
+ *		the size of our frame is not known until afterwards, so the
+ *		body is first generated into a buffer.  This allows us to
+ *		use an immediate operand when allocating our frame, and
+ *		to apply the peephole optimizer to the body.  The space for
+ *		any arguments passed on the stack lies below everything
+ *		else, at the bottom of our frame.
+ *
+ *		A leaf function, which calls no other functions, has no
+ *		frame and its base pointer is simply the stack pointer on
+ *		entry.  If the local variables fit within the red zone
+ *		below the stack pointer, then they are addressed using the
+ *		stack pointer and no setup is required at all.  Otherwise,
+ *		we adjust the stack pointer and save the caller's base
+ *		pointer below the local variables.
+ */
+
+void Function::generate()
+{
+    int param_offset;
+    unsigned size, outgoing;
+    Parameters *params;
+    Symbols symbols;
+    ostringstream body;
+    streambuf *saved;
+    string text;
+    size_t pos;
+    bool leaf;
+
+
+    /* Assign offsets to the parameters and local variables.  A leaf
+       function does not push the base pointer. */
+
+    leaf = !_body->calls();
+    param_offset = (leaf ? 1 : 2) * SIZEOF_REG;
+    offset = param_offset;
+    allocate(offset, outgoing);
+
+
+    /* Propagate constants and find any dead assignments now that we
+       know which variables are local. */
+
+    if (sccp) {
+	Constants constants;
+	propagate(constants);
+    }
+
+    if (dce) {
+	Variables live;
+	liveness(live);
+    }
+
+
+    /* Find the ranges of the local variables so that we can omit sign
+       extensions of values known to be non-negative. */
+
+    if (vrp)
+	bound(ranges);
+    else
+	ranges.clear();
+
+    funcname = _id->name();
+    function = _id;
+    saved = cout.rdbuf(body.rdbuf());
+    forget();
+    facts.clear();
+
+
+    /* Spill any parameters. */
+
+    params = _id->type().parameters();
+    symbols = _body->declarations()->symbols();
+
+    for (unsigned i = 0; i < NUM_PARAM_REGS; i ++)
+	if (i < params->size()) {
+	    size = symbols[i]->type().size();
+	    cout << "\tmov" << suffix(size) << parameters[i]->name(size);
+	    cout << ", " << symbols[i]->_offset << "(%rbp)" << endl;
+
+	    if (cse)
+		values[parameters[i]].insert(Identifier(symbols[i]).key());
+	} else
+	    break;
+
+
+    /* Generate the body of this function. */
+
+    _body->generate();
+    cout << endl << global_prefix << funcname << ".exit:" << endl;
+    cout.rdbuf(saved);
+    text = body.str();
+
+    if (peephole)
+	text = optimizeInstructions(text);
+
+
+    /* Generate our prologue, the body, and our epilogue. */
+
+    cout << global_prefix << funcname << ":" << endl;
+
+    if (!leaf) {
+	offset -= align(offset - param_offset);
+	offset -= (int) (outgoing + align(outgoing));
+	cout << "\tpushq\t%rbp" << endl;
+	cout << "\tmovq\t%rsp, %rbp" << endl;
+
+	if (offset < 0)
+	    cout << "\tsubq\t$" << -offset << ", %rsp" << endl;
+
+	cout << global_prefix << funcname << ".entry:" << endl;
+	cout << text;
+	cout << "\tmovq\t%rbp, %rsp" << endl;
+	cout << "\tpopq\t%rbp" << endl;
+
+    } else if (-offset <= RED_ZONE_SIZE) {
+	while ((pos = text.find("(%rbp)")) != string::npos)
+	    text.replace(pos, 6, "(%rsp)");
+
+	cout << text;
+
+    } else {
+	size = -offset + SIZEOF_REG;
+	cout << "\tsubq\t$" << size << ", %rsp" << endl;
+	cout << "\tmovq\t%rbp, (%rsp)" << endl;
+	cout << "\tleaq\t" << size << "(%rsp), %rbp" << endl;
+	cout << text;
+	cout << "\tmovq\t(%rsp), %rbp" << endl;
+	cout << "\taddq\t$" << size << ", %rsp" << endl;
+    }
+
+    cout << "\tret" << endl << endl;
+    cout << "\t.globl\t" << global_prefix << funcname << endl << endl;
+}
+
+
+/*
+ * Function:	alignment (private)
+ *
+ * Description:	Return the alignment of a global variable.  An array large
+ *		enough to hold a vector is aligned so that it can be
+ *		accessed using aligned vector loads, and one that fills a
+ *		cache line is aligned on a cache line.
+ */
+
+static unsigned alignment(const Symbol *symbol)
+{
+    unsigned long size = symbol->type().size();
+
+    if (!symbol->type().isArray() || size < SIZEOF_VECTOR)
+	return symbol->type().alignment();
+
+    if (size >= CACHE_LINE_SIZE)
+	return max(array_alignment, (unsigned) CACHE_LINE_SIZE);
+
+    return array_alignment;
+}
+
+
+/*
+ * Function:	backwards (private)
+ *
+ * Description:	Return whether the first string comes before the second
+ *		when both are read backwards.  Sorting strings this way
+ *		places each string just before those that end with it.
+ */
+
+static bool backwards(const string &first, const string &second)
+{
+    return lexicographical_compare(first.rbegin(), first.rend(),
+				   second.rbegin(), second.rend());
+}
+
+
+/*
+ * Function:	ends (private)
+ *
+ * Description:	Return whether the first string ends with the second.
+ */
+
+static bool ends(const string &s, const string &suffix)
+{
+    if (s.size() < suffix.size())
+	return false;
+
+    return s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+
+/*
+ * Function:	generateStrings (private)
+ *
+ * Description:	Generate the string literals as read-only data.  They are
+ *		placed in a section of mergeable strings, so that the
+ *		linker can share identical literals across files.  A
+ *		literal that ends another is not written at all, but is
+ *		labeled within the longer literal instead.  A literal
+ *		containing a null character cannot be merged, so it is
+ *		placed with the other constants.
+ */
+
+static void generateStrings()
+{
+    vector<string> literals, others;
+    size_t start, end;
+    unsigned first;
+
+
+    for (auto &entry : strings)
+	if (entry.first.find('\0') == string::npos)
+	    literals.push_back(entry.first);
+	else
+	    others.push_back(entry.first);
+
+    sort(literals.begin(), literals.end(), backwards);
+
+    if (literals.size() > 0)
+	cout << string_section << endl;
+
+    first = 0;
+
+    for (unsigned i = 0; i < literals.size(); i ++) {
+	if (i + 1 < literals.size() && ends(literals[i + 1], literals[i]))
+	    continue;
+
+	const string &whole = literals[i];
+
+	for (unsigned j = i + 1; j > first; j --) {
+	    start = whole.size() - literals[j - 1].size();
+	    end = j - 1 > first ? whole.size() - literals[j - 2].size() : whole.size();
+	    cout << strings[literals[j - 1]] << ":\t";
+	    cout << (j - 1 > first ? ".ascii" : ".asciz") << "\t\"";
+	    cout << escapeString(whole.substr(start, end - start)) << "\"\n";
+	}
+
+	first = i + 1;
+    }
+
+    if (others.size() > 0)
+	cout << const_section << endl;
+
+    for (auto &literal : others)
+	cout << strings[literal] << ":\t.asciz\t\"" << escapeString(literal) << "\"\n";
+}
+
+
+/*
+ * Function:	generateGlobals
+ *
+ * Description:	Generate code for any global variable declarations.  Simple
+ *		C has no extern declarations, so a variable shared between
+ *		files is declared in each, and every variable must remain
+ *		a common symbol that the linker merges.  Each is given an
+ *		explicit alignment, although its placement is then up to
+ *		the linker.
+ */
+
+void generateGlobals(Scope *scope)
+{
+    const Symbols &symbols = scope->symbols();
+    unsigned align, shift;
+
+    for (auto symbol : symbols)
+	if (!symbol->type().isFunction()) {
+	    align = alignment(symbol);
+
+	    if (comm_log2) {
+		for (shift = 0; (1u << shift) < align; shift ++)
+		    ;
+
+		align = shift;
+	    }
+
+	    cout << "\t.comm\t" << global_prefix << symbol->name() << ", ";
+	    cout << symbol->type().size() << ", " << align << endl;
+	}
+
+    generateStrings();
+}
+
+
+/*
+ * Function:	modify (private)
+ *
+ * Description:	Attempt to generate an assignment of the form left = left
+ *		op right, where op is an additive, bitwise, or shift
+ *		operator, as a single instruction that reads, modifies, and
+ *		writes the left-hand side in place, and return whether we
+ *		did.  The address of a dereference is computed only once.
+ *		An operation on a promoted operand that is converted back
+ *		is done at the original size, since only the low-order bits
+ *		of the result matter, but only for a constant and never for
+ *		a right shift.  A shift count that is not a constant must be
+ *		in %cl.
+ */
+
+static bool modify(Expression *left, Expression *right)
+{
+    Expression *target, *operand, *pointer;
+    Binary *binary;
+    Cast *narrowed, *cast;
+    unsigned long value;
+    bool immediate, indirect, shift, commutes;
+    string opcode, key;
+
+
+    key = left->key();
+
+    if (key.empty())
+	return false;
+
+    if ((narrowed = dynamic_cast<Cast *>(right)) != nullptr)
+	right = narrowed->expr();
+
+    if (dynamic_cast<Add *>(right) != nullptr)
+	opcode = "add";
+    else if (dynamic_cast<Subtract *>(right) != nullptr)
+	opcode = "sub";
+    else if (dynamic_cast<BitwiseAnd *>(right) != nullptr)
+	opcode = "and";
+    else if (dynamic_cast<BitwiseXor *>(right) != nullptr)
+	opcode = "xor";
+    else if (dynamic_cast<BitwiseOr *>(right) != nullptr)
+	opcode = "or";
+    else if (dynamic_cast<LeftShift *>(right) != nullptr)
+	opcode = "shl";
+    else if (dynamic_cast<RightShift *>(right) == nullptr || narrowed != nullptr)
+	return false;
+    else
+	opcode = right->type().isUnsigned() ? "shr" : "sar";
+
+    binary = static_cast<Binary *>(right);
+    target = binary->left();
+    operand = binary->right();
+
+    shift = opcode == "shl" || opcode == "shr" || opcode == "sar";
+    commutes = opcode != "sub" && !shift;
+
+    if (commutes && target->key() != key)
+	if (narrowed == nullptr || dynamic_cast<Cast *>(target) == nullptr)
+	    swap(target, operand);
+
+    immediate = operand->isNumber(value);
+
+    if (narrowed != nullptr) {
+	if ((cast = dynamic_cast<Cast *>(target)) == nullptr || !immediate)
+	    return false;
+
+	target = cast->expr();
+	value = left->type().normalize(value);
+
+    } else if (binary->type().size() != left->type().size())
+	return false;
+
+    else if (immediate && (long) value != (int) value)
+	immediate = false;
+
+    if (target->key() != key)
+	return false;
+
+    if (shift && immediate)
+	value &= binary->type().size() * 8 - 1;
+
+    if (!immediate) {
+	operand->generate();
+	fetch(operand);
+    }
+
+    indirect = left->isDereference(pointer);
+
+    if (indirect)
+	pointer->generate();
+
+    if (!immediate && shift)
+	load(operand, rcx);
+    else if (!immediate && operand->_register == nullptr)
+	load(operand, getreg(operand));
+
+    if (indirect && pointer->_register == nullptr)
+	load(pointer, getreg(pointer));
+
+    cout << "\t" << opcode << suffix(left);
+
+    if (immediate)
+	cout << "$" << (long) value;
+    else if (shift)
+	cout << "%cl";
+    else
+	cout << operand;
+
+    if (indirect)
+	cout << ", (" << pointer << ")" << endl;
+    else
+	cout << ", " << left << endl;
+
+    if (!immediate)
+	assign(operand, nullptr);
+
+    if (indirect)
+	assign(pointer, nullptr);
+
+    return true;
+}
+
+
+/*
+ * Function:	Assignment::generate
+ *
+ * Description:	Generate code for an assignment statement.  A dead
+ *		assignment is never read, and so the right-hand side is
+ *		only generated if it has some other effect.  If the value
+ *		assigned is known, then so is the left-hand side afterwards.
+ *		An assignment that combines its left-hand side with another
+ *		operand using an additive, bitwise, or shift operator
+ *		modifies it in place.
+ */
+
+void Assignment::generate()
+{
+    Expression * pointer;
+    bool known;
+    long value;
+
+    if (dce && _dead) {
+	if (!_right->pure()) {
+	    _right->generate();
+	    assign(_right, nullptr);
+	}
+
+	clobber(Location(_left));
+	return;
+    }
+
+    known = _left->type().isNumeric() && evaluate(_right, value);
+
+    if (modify(_left, _right)) {
+	clobber(Location(_left));
+
+	if (thread_limit > 0 && known)
+	    facts[_left->key()] = _left->type().normalize(value);
+
+	return;
+    }
+
+    _right->generate();
+    // assert(dynamic_cast<Number *>(_right));
+    // assert(dynamic_cast<Identifier *>(_left));
+
+    if(_left->isDereference(pointer))
+    {
+        pointer->generate();
+
+        if(pointer->_register == nullptr)
+            load(pointer, getreg(pointer));
+
+        if  (_right->_register == nullptr)
+            load(_right, getreg(_right));
+
+        cout << "\tmov" << suffix(_left) << _right << ", (" << pointer << ")\n";
+
+        assign(pointer, nullptr);
+    }
+    else{
+        unsigned long val;
+
+        if(!_right->isNumber(val) && _right->_register == nullptr)
+        {
+                load(_right, getreg(_right));
+        }
+        
+        cout << "\tmov" << suffix(_right) << _right;
+        cout << ", " << _left << endl;
+    }
+
+    clobber(Location(_left));
+
+    if (cse && _right->_register != nullptr)
+        values[_right->_register].insert(_left->key());
+
+    if (thread_limit > 0 && known)
+        facts[_left->key()] = _left->type().normalize(value);
+
+    assign(_right, nullptr);
+}
+
+/* Add, mul, sub  computation */
+static void compute(Expression* result, Expression* left, Expression* right, const string& opcode)
+{
+    if (reuse(result))
+        return;
+
+    left->generate();
+    right->generate();
+    fetch(right);
+
+    if(left->_register == nullptr){
+        load(left, getreg());
+    }
+
+    cout << "\t" << opcode << suffix(result) << right;
+    cout << ", " << left << endl;
+
+    assign(right, nullptr);
+    assign(result, left->_register);
+}
+
+void Add::generate()
+{
+    compute(this, _left, _right, "add");
+}
+
+void Subtract::generate()
+{
+    compute(this, _left, _right, "sub");
+}
+
+void Multiply::generate()
+{
+    compute(this, _left, _right, "imul");
+}
+
+void BitwiseAnd::generate()
+{
+    compute(this, _left, _right, "and");
+}
+
+void BitwiseXor::generate()
+{
+    compute(this, _left, _right, "xor");
+}
+
+void BitwiseOr::generate()
+{
+    compute(this, _left, _right, "or");
+}
+
+
+/*
+ * Function:	computeShift (private)
+ *
+ * Description:	Generate code for a shift.  A constant count is an
+ *		immediate operand, masked to the width of the result just
+ *		as the processor would, and any other count must be in
+ *		%cl.
+ */
+
+static void computeShift(Expression *result, Expression *left, Expression *right, const string &opcode)
+{
+    unsigned long count;
+
+    if (reuse(result))
+        return;
+
+    left->generate();
+
+    if (right->isNumber(count)) {
+        if (left->_register == nullptr)
+            load(left, getreg());
+
+        count &= result->type().size() * 8 - 1;
+        cout << "\t" << opcode << suffix(result) << "$" << count;
+        cout << ", " << left << endl;
+
+    } else {
+        right->generate();
+        load(right, rcx);
+
+        if (left->_register == nullptr)
+            load(left, getreg());
+
+        cout << "\t" << opcode << suffix(result) << "%cl, " << left << endl;
+        assign(right, nullptr);
+    }
+
+    assign(result, left->_register);
+}
+
+void LeftShift::generate()
+{
+    computeShift(this, _left, _right, "shl");
+}
+
+void RightShift::generate()
+{
+    computeShift(this, _left, _right, _type.isUnsigned() ? "shr" : "sar");
+}
+
+/*
+ * Function:	computeDiv (private)
+ *
+ * Description:	Generate code for a division or remainder.  An unsigned
+ *		division by a known power of two is a right shift, and the
+ *		remainder is a mask of the low-order bits.  Otherwise, an
+ *		unsigned dividend is zero-extended rather than
+ *		sign-extended into %rdx.
+ */
+
+static void computeDiv(Expression* result, Expression* left, Expression* right, const string& op)
+{
+    unsigned shift;
+    long value;
+
+    if (reuse(result))
+        return;
+
+    if (result->type().isUnsigned() && evaluate(right, value))
+        if (value > 0 && (value & (value - 1)) == 0 && value - 1 <= INT_MAX) {
+            for (shift = 0; (1L << shift) < value; shift ++)
+                continue;
+
+            left->generate();
+
+            if (left->_register == nullptr)
+                load(left, getreg());
+
+            if (op == "div")
+                cout << "\tshr" << suffix(result) << "$" << shift;
+            else
+                cout << "\tand" << suffix(result) << "$" << value - 1;
+
+            cout << ", " << left << endl;
+            assign(result, left->_register);
+            return;
+        }
+
+    left->generate();
+    right->generate();
+
+    load(left, rax);
+    load(nullptr, rdx);
+    load(right, rcx);
+
+    if (result->type().isUnsigned())
+        cout << "\txorl\t%edx, %edx\n";
+    else if(result->type().size() == 4)
+        cout << "\tcltd\n";
+    else
+        cout << "\tcqto\n";
+
+    cout << (result->type().isUnsigned() ? "\tdiv" : "\tidiv");
+    cout << suffix(result) << right << endl;
+    values[rax].clear();
+    values[rdx].clear();
+
+    assign(left, nullptr);
+    assign(right, nullptr);
+
+    if(op == "div")
+        assign(result, rax);
+    else
+        assign(result, rdx);
+}
+
+
+void Divide::generate()
+{
+    computeDiv(this, _left, _right, "div");
+}
+
+void Remainder::generate()
+{
+    computeDiv(this, _left, _right, "rem");
+}
+
+/*
+ * Function:	condition (private)
+ *
+ * Description:	Return the condition code for a comparison of operands of
+ *		the given type, given the code for signed operands.
+ *		Unsigned operands are below or above rather than less or
+ *		greater.
+ */
+
+static string condition(const string &cc, const Type &type)
+{
+    static map<string, string> codes = {
+	{"l", "b"}, {"g", "a"}, {"le", "be"}, {"ge", "ae"},
+    };
+
+    if (type.isUnsigned() && codes.count(cc) > 0)
+	return codes[cc];
+
+    return cc;
+}
+
+
+/* Relational and Equality Operators */
+static void computeComp(Expression* result, Expression* left, Expression* right, const string& op)
+{
+    if (reuse(result))
+        return;
+
+    left->generate();
+    right->generate();
+    fetch(right);
+
+    if(left->_register == nullptr)
+        load(left, getreg(left));
+    cout << "\tcmp" << suffix(left) << right << ", " << left->_register << endl;
+
+    assign(left, nullptr);
+    assign(right, nullptr);
+
+    assign(result, getreg());
+
+    cout << "\tset" << condition(op, left->type()) << "\t" << result->_register->byte() << endl;
+    cout << "\tmovzbl\t" << result->_register->byte() << ", " << result->_register->name(4) << endl;
+}
+
+void LessThan::generate()
+{
+    computeComp(this, _left, _right, "l");
+}
+
+void GreaterThan::generate()
+{
+    computeComp(this, _left, _right, "g");
+}
+
+void LessOrEqual::generate()
+{
+    computeComp(this, _left, _right, "le");
+}
+
+void GreaterOrEqual::generate()
+{
+    computeComp(this, _left, _right, "ge");
+}
+
+void Equal::generate()
+{
+    computeComp(this, _left, _right, "e");
+}
+
+void NotEqual::generate()
+{
+    computeComp(this, _left, _right, "ne");
+}
+
+/* unary not and neg */
+void Not::generate()
+{
+    if (reuse(this))
+        return;
+
+    _expr->generate();
+
+    if(_expr->_register == nullptr)
+        load(_expr, getreg());
+
+    cout << "\tcmp" << suffix(_expr) << "$0, " << _expr << endl;
+    cout << "\tsete\t" << _expr->_register->byte() << endl;
+    cout << "\tmovzbl\t" << _expr->_register->byte() << ", " << _expr->_register->name(4) << endl;
+
+    assign(this, _expr->_register);
+}
+
+void Negate::generate()
+{
+    if (reuse(this))
+        return;
+
+    _expr->generate();
+    if(_expr->_register == nullptr)
+        load(_expr, getreg());
+
+    cout << "\tneg" <<  suffix(_expr) << _expr->_register << endl;
+
+    assign(this, _expr->_register);
+}
+
+void Complement::generate()
+{
+    if (reuse(this))
+        return;
+
+    _expr->generate();
+    if(_expr->_register == nullptr)
+        load(_expr, getreg());
+
+    cout << "\tnot" << suffix(_expr) << _expr->_register << endl;
+
+    assign(this, _expr->_register);
+}
+
+
+void Expression::test(const Label& label, bool ifTrue){
+    generate();
+
+    if(_register == nullptr)
+        load(this, getreg(this));
+
+    cout << "\tcmp" << suffix(this) << "$0, " << this << endl;
+    cout << (ifTrue ? "\tjne\t" : "\tje\t") << label << endl;
+
+    assign(this, nullptr);
+}
+
+/*
+ * Function:	Node::loops
+ *
+ * Description:	Return whether this node contains a loop, in which case
+ *		the code for a loop containing it is generated only once.
+ */
+
+bool Node::loops() const
+{
+    return false;
+}
+
+
+/*
+ * The remaining functions simply check the children of each node, and
+ * aren't very interesting.  Note that an inlined call may contain a loop.
+ */
+
+bool Unary::loops() const
+{
+    return _expr->loops();
+}
+
+bool Binary::loops() const
+{
+    return _left->loops() || _right->loops();
+}
+
+bool Call::loops() const
+{
+    for (auto arg : _args)
+	if (arg->loops())
+	    return true;
+
+    return false;
+}
+
+bool Inline::loops() const
+{
+    return _body->loops();
+}
+
+bool Assignment::loops() const
+{
+    return _left->loops() || _right->loops();
+}
+
+bool Return::loops() const
+{
+    return _expr->loops();
+}
+
+bool Block::loops() const
+{
+    for (auto stmt : _stmts)
+	if (stmt->loops())
+	    return true;
+
+    return false;
+}
+
+bool While::loops() const
+{
+    return true;
+}
+
+bool For::loops() const
+{
+    return true;
+}
+
+bool If::loops() const
+{
+    if (_expr->loops() || _thenStmt->loops())
+	return true;
+
+    return _elseStmt != nullptr && _elseStmt->loops();
+}
+
+bool Switch::loops() const
+{
+    if (_expr->loops())
+	return true;
+
+    for (auto stmt : _stmts)
+	if (stmt->loops())
+	    return true;
+
+    return false;
+}
+
+bool Simple::loops() const
+{
+    return _expr->loops();
+}
+
+
+/*
+ * Function:	loop (private)
+ *
+ * Description:	Generate code for the test, body, and increment of a loop
+ *		starting at the given label and leaving at the other.
+ *
+ *		The values held in registers at the top of the loop must
+ *		hold both on entry and along the back edge, which isn't
+ *		known until the body has been generated.  So, we assume
+ *		that the values on entry still hold, generate the loop into
+ *		a buffer, and check the assumption at the bottom.  If it
+ *		fails, then we try again keeping only those values that
+ *		held, and with any locations changed within the loop given
+ *		new versions at the top.  The third attempt assumes nothing
+ *		and always succeeds.  The loop is left only from the test,
+ *		so the state afterwards is the state after the test, with
+ *		the test known to be false.  Any facts known on entry are
+ *		assumed to hold at the top just like the values, except on
+ *		the last attempt.  A test that is always true is omitted,
+ *		and any other is known to be true within the body.  The
+ *		body and the increment are repeated the given number of
+ *		times within each iteration if the loop is unrolled.
+ *
+ *		Each attempt generates any inner loops again, so a loop
+ *		containing another loop skips straight to the last
+ *		attempt, keeping compile time linear in the depth of the
+ *		nest.  Any locations found to change within the loop on
+ *		the last attempt are given new versions on leaving it.
+ */
+
+static void loop(Expression *expr, Statement *stmt, Statement *incr,
+		 const Label &top, const Label &exit, unsigned copies = 1)
+{
+    State entry, assumed, exiting, bottom;
+    set<string> changed;
+    bool valid, tested;
+    map<Register *, set<string>> held;
+    unsigned attempt, count, i;
+    unsigned long value;
+    streambuf *saved;
+    int start;
+
+
+    entry = save();
+    held = entry.values;
+    start = offset;
+    attempt = 0;
+
+    if (expr->loops() || stmt->loops() || (incr != nullptr && incr->loops())) {
+	held.clear();
+	attempt = 2;
+    }
+
+    for (; ; attempt ++) {
+	ostringstream buffer;
+
+	restore(entry);
+	values = held;
+	offset = start;
+
+	for (auto &name : changed)
+	    versions[name] = ++ generation;
+
+	if (attempt == 2)
+	    facts.clear();
+
+	assumed = save();
+	saved = cout.rdbuf(buffer.rdbuf());
+	cout << top << ":" << endl;
+	tested = !dce || !expr->isNumber(value) || value == 0;
+
+	if (tested)
+	    expr->test(exit, false);
+
+	exiting = save();
+
+	if (tested && thread_limit > 0)
+	    assume(expr, true);
+
+	for (i = 0; i < copies; i ++) {
+	    stmt->generate();
+
+	    if (incr != nullptr)
+		incr->generate();
+	}
+
+	cout << "\tjmp\t" << top << endl;
+	cout.rdbuf(saved);
+	bottom = save();
+
+
+	/* Check that the locations changed were given new versions and
+	   that the values assumed at the top still hold at the bottom.  A
+	   location first used within the loop has version zero. */
+
+	count = changed.size();
+
+	for (auto &entry : bottom.versions) {
+	    auto version = assumed.versions.find(entry.first);
+
+	    if (version == assumed.versions.end()) {
+		if (entry.second != 0)
+		    changed.insert(entry.first);
+	    } else if (version->second != entry.second)
+		changed.insert(entry.first);
+	}
+
+	valid = count == changed.size() && holds(assumed, bottom);
+
+	if (valid || attempt == 2) {
+	    cout << buffer.str();
+	    break;
+	}
+
+	held = meet(assumed, bottom).values;
+
+	if (attempt == 1)
+	    held.clear();
+    }
+
+    cout << exit << ":" << endl;
+    restore(exiting);
+
+    if (!valid)
+	for (auto &name : changed)
+	    versions[name] = ++ generation;
+
+    if (tested && thread_limit > 0)
+	assume(expr, false);
+}
+
+
+void While::generate()
+{
+    cout << "# while" <<endl;
+    unsigned long value;
+
+    if (dce && _expr->isNumber(value) && value == 0)
+        return;
+
+    iterate(nullptr, _expr, nullptr, _stmt);
+}
+
+void Address::generate(){
+
+    Expression *pointer;
+
+    if (reuse(this))
+        return;
+
+    if(_expr->isDereference(pointer)) {
+        pointer->generate();
+
+        if(pointer->_register == nullptr)
+            load(pointer, getreg(pointer));
+        
+        assign(this, pointer->_register);
+    }
+    else {
+        assign(this, getreg());
+        cout << "\tleaq\t" << _expr << ", " << this <<endl;
+    }
+}
+
+/*
+ * Function:	dereference (private)
+ *
+ * Description:	Load the value pointed to by the given dereference into a
+ *		register, extending it to the given size, and assign the
+ *		register to the given result.
+ */
+
+static void dereference(Dereference *expr, Expression *result, unsigned size)
+{
+    Expression *pointer = expr->expr();
+    Register *reg;
+    unsigned width;
+
+    pointer->generate();
+
+    if(pointer->_register == nullptr)
+        load(pointer, getreg(pointer));
+
+    reg = pointer->_register;
+
+    if (cse && !pointer->key().empty())
+        for (auto free : registers)
+            if (free->_node == nullptr && values[free].empty()) {
+                reg = free;
+                break;
+            }
+
+    cout << extension(expr->type(), size, width) << "(" << pointer << "), " << reg->name(width) <<endl;
+
+    assign(pointer, nullptr);
+    assign(result, reg);
+}
+
+void Dereference::generate(){
+    if (reuse(this))
+        return;
+
+    dereference(this, this, _type.size());
+}
+
+void String::operand(ostream &ostr) const{
+
+    auto val = strings.find(value());
+
+    if (val == strings.end()){
+        auto label = strings.insert({value(), Label()});
+        ostr << label.first->second;
+    }
+    else{
+        ostr << val->second;
+    }
+}
+
+void Return::generate(){
+    Call *call;
+    bool last;
+
+
+    last = inlined == nullptr || inlinedTail;
+
+    if (last && (call = dynamic_cast<Call *>(_expr)) != nullptr)
+	if (call->generateTail())
+	    return;
+
+    tail = last && dynamic_cast<Inline *>(_expr) != nullptr;
+    _expr->generate();
+
+    if (inlined != nullptr) {
+	if (_expr->_register == nullptr)
+	    load(_expr, getreg(_expr));
+
+	cout << "\tmov" << suffix(_expr) << _expr << ", " << inlined << endl;
+	cout << "\tjmp\t" << *inlinedExit << endl;
+
+	assign(_expr, nullptr);
+	return;
+    }
+
+    load(_expr, rax);
+
+    cout << "\tjmp\t" << funcname << ".exit\n";
+
+    assign(_expr, nullptr);
+}
+
+void Cast::generate(){
+    Register* reg, *copy;
+    unsigned source, target, width;
+    unsigned long value;
+    long low, high;
+    bool clear;
+
+    if (reuse(this))
+        return;
+
+    source = _expr->type().size();
+    target = _type.size();
+    clear = source == SIZEOF_INT && _expr->range(ranges, low, high) && low >= 0;
+
+
+    /* A value read from memory, or copied from a register that holds
+       it, is extended as it is moved. */
+
+    Dereference *pointer = dynamic_cast<Dereference *>(_expr);
+
+    if (source < target && pointer != nullptr && cached(_expr) == nullptr) {
+        dereference(pointer, this, target);
+        return;
+    }
+
+    _expr->generate();
+
+    if (source < target && !clear && _expr->_register == nullptr && !_expr->isNumber(value)) {
+        copy = cached(_expr);
+        reg = getreg();
+        cout << extension(_expr->type(), target, width);
+
+        if (copy != nullptr)
+            cout << copy->name(source);
+        else
+            cout << _expr;
+
+        cout << ", " << reg->name(width) << endl;
+        assign(this, reg);
+        return;
+    }
+
+    if(source >= target)
+    {
+        load(_expr, getreg(_expr));
+        assign(this, _expr->_register);
+    }
+    else {
+        if(_expr->_register == nullptr)
+            load(_expr, getreg());
+
+        if (clear) {
+            /* The upper half of the register is already clear. */
+        }
+        else if (_expr->type().isUnsigned()) {
+            if (source == 1)
+                cout << "\tmovzb" << suffix(target) << _expr->_register << ", " << _expr->_register->name(target) << endl;
+            else
+                cout << "\tmovl\t" << _expr->_register << ", " << _expr->_register << endl;
+        }
+        else if(source == 1 &&  target == 4){
+            cout << "\tmovsbl\t" << _expr->_register << ", " << _expr->_register->name(target) << endl;
+        }
+        else if(source == 1 && target == 8){
+            cout << "\tmovsbq\t" << _expr->_register << ", " << _expr->_register->name(target) << endl;
+        }
+        else{
+            cout << "\tmovslq\t" << _expr->_register << ", " << _expr->_register->name(target) << endl;
+        }
+
+        assign(this, _expr->_register);
+    }
+}
+
+void LogicalOr::generate(){
+    cout << "# or" <<endl;
+    auto success = Label();
+    auto exit = Label();
+
+    for (auto reg : registers)
+	load(nullptr, reg);
+
+    _left->test(success, true);
+    _right->test(success, true);
+
+    assign(this, getreg());
+
+    cout << "\tmov" << suffix(this) << "$0, " << this << endl;
+    cout << "\tjmp\t" << exit << endl;
+    cout << success << ":\n" << "\tmov" << suffix(this) << "$1, " << this << endl;
+    cout << exit << ":\n";
+    forget();
+}
+
+void LogicalAnd::generate(){
+    auto success = Label();
+    auto exit = Label();
+
+    for (auto reg : registers)
+	load(nullptr, reg);
+
+    _left->test(exit, false);
+    _right->test(exit, false);
+
+    assign(this, getreg());
+    cout << "\tmov" << suffix(this) << "$1, " << this << endl;
+    cout << "\tjmp\t" << success << endl;
+
+    cout << exit << ":\n" << "\tmov" << suffix(this) << "$0, " << this << endl;
+    cout << success << ":\n";
+    forget();
+}
+
+/*
+ * Function:	widen (private)
+ *
+ * Description:	Load the given integer operand into the given register,
+ *		extending it to a quad word if necessary.  Writing the low
+ *		double word of a register clears the rest, so an unsigned
+ *		operand or one known to be non-negative is simply moved.
+ */
+
+static void widen(Expression *expr, Register *reg)
+{
+    unsigned long value;
+    long low, high;
+
+
+    if (expr->isNumber(value) || expr->type().size() == SIZEOF_LONG)
+	cout << "\tmovq\t" << expr << ", " << reg->name() << endl;
+    else if (expr->type().isUnsigned() ||
+	     (expr->range(ranges, low, high) && low >= 0))
+	cout << "\tmovl\t" << expr << ", " << reg->name(SIZEOF_INT) << endl;
+    else
+	cout << "\tmovslq\t" << expr << ", " << reg->name() << endl;
+
+    assign(expr, reg);
+}
+
+
+/*
+ * Function:	packed (private)
+ *
+ * Description:	Return the SSE2 packed integer opcode for the given
+ *		operation on elements of the given size.
+ */
+
+static string packed(const string &op, unsigned long size)
+{
+    return "p" + op + (size == 1 ? "b" : (size == 4 ? "d" : "q"));
+}
+
+
+/*
+ * Function:	narrow (private)
+ *
+ * Description:	Strip the cast that promotes a character operand to an
+ *		integer or that truncates an integer result back to a
+ *		character.  Packed byte arithmetic wraps identically, so
+ *		neither is needed when operating on whole vectors of
+ *		characters.
+ */
+
+static Expression *narrow(Expression *expr, unsigned long size)
+{
+    Cast *cast;
+
+
+    if (size == SIZEOF_CHAR && (cast = dynamic_cast<Cast *>(expr)) != nullptr)
+	return cast->expr();
+
+    return expr;
+}
+
+
+/*
+ * Function:	isCounter (private)
+ *
+ * Description:	Return whether the given expression is a reference to the
+ *		given loop counter, possibly sign-extended to a long as
+ *		scale() does for an integer index.
+ */
+
+static bool isCounter(Expression *expr, const Symbol *counter)
+{
+    Identifier *id;
+    Cast *cast;
+
+
+    if ((cast = dynamic_cast<Cast *>(expr)) != nullptr)
+	expr = cast->expr();
+
+    id = dynamic_cast<Identifier *>(expr);
+    return id != nullptr && id->symbol() == counter;
+}
+
+
+/*
+ * Function:	baseSymbol (private)
+ *
+ * Description:	Return the symbol of an array base, which is either a
+ *		promoted array or a pointer variable, or null if the base
+ *		is any other expression.
+ */
+
+static const Symbol *baseSymbol(Expression *expr)
+{
+    Address *address;
+    Identifier *id;
+
+
+    if ((address = dynamic_cast<Address *>(expr)) != nullptr)
+	expr = address->expr();
+
+    if ((id = dynamic_cast<Identifier *>(expr)) != nullptr)
+	return id->symbol();
+
+    return nullptr;
+}
+
+
+/*
+ * Function:	isElement (private)
+ *
+ * Description:	Return whether the given expression is an array element,
+ *		and if so return its base and its scaled index.  The
+ *		checker builds a[i] as *(a + i * size), where the size is
+ *		that of the element, and folds the multiplication if the
+ *		index is a constant.
+ */
+
+static bool isElement(Expression *expr, Expression *&base, Expression *&index)
+{
+    Expression *pointer;
+    Add *add;
+
+
+    if (!expr->isDereference(pointer) || !expr->type().isScalar())
+	return false;
+
+    if ((add = dynamic_cast<Add *>(pointer)) == nullptr)
+	return false;
+
+    base = add->left();
+    index = add->right();
+    return baseSymbol(base) != nullptr;
+}
+
+
+/*
+ * Function:	isScaledCounter (private)
+ *
+ * Description:	Return whether the given scaled index is the given loop
+ *		counter multiplied by the given element size.
+ */
+
+static bool isScaledCounter(Expression *index, const Symbol *counter,
+			    unsigned long size)
+{
+    Multiply *mul;
+    unsigned long value;
+
+
+    if ((mul = dynamic_cast<Multiply *>(index)) == nullptr)
+	return false;
+
+    if (!mul->right()->isNumber(value) || value != size)
+	return false;
+
+    return isCounter(mul->left(), counter);
+}
+
+
+/*
+ * Function:	isElementwise (private)
+ *
+ * Description:	Return whether the given assignment is an element-wise
+ *		operation, a[x] = b[y] op c[z], where op is + or -, or is
+ *		missing for a copy, and all elements have the same type.
+ *		The opcode and the elements, destination first, are
+ *		returned.
+ */
+
+static bool isElementwise(Assignment *stmt, string &opcode, Expressions &elements)
+{
+    Expression *dest, *expr, *base, *index;
+    unsigned long size;
+    Binary *binary;
+
+
+    dest = stmt->left();
+
+    if (!isElement(dest, base, index))
+	return false;
+
+    size = dest->type().size();
+    expr = narrow(stmt->right(), size);
+    elements.clear();
+    elements.push_back(dest);
+
+    if (isElement(expr, base, index)) {
+	opcode = "";
+	elements.push_back(expr);
+
+    } else {
+	if (!dest->type().isNumeric())
+	    return false;
+
+	if ((binary = dynamic_cast<Add *>(expr)) != nullptr)
+	    opcode = "add";
+	else if ((binary = dynamic_cast<Subtract *>(expr)) != nullptr)
+	    opcode = "sub";
+	else
+	    return false;
+
+	elements.push_back(narrow(binary->left(), size));
+	elements.push_back(narrow(binary->right(), size));
+    }
+
+    for (auto expr : elements)
+	if (!isElement(expr, base, index) || expr->type() != dest->type())
+	    return false;
+
+    return true;
+}
+
+
+/*
+ * Function:	superword (private)
+ *
+ * Description:	Attempt to pack a run of isomorphic element-wise
+ *		assignments on consecutive constant indices, such as
+ *
+ *		    a[0] = b[0] + c[0]; a[1] = b[1] + c[1]; ...
+ *
+ *		into SSE2 operations, starting at the given statement.  The
+ *		number of statements packed is returned, which is always a
+ *		multiple of the number of elements in a vector.
+ *
+ *		Each packed group reads all of its sources before writing
+ *		its destination, so we only pack elements whose bases are
+ *		distinct arrays, or the same base if no later source in a
+ *		group is overwritten by an earlier store.  A store of a
+ *		character might modify a pointer used as a base, so we
+ *		only pack characters whose bases are arrays.
+ */
+
+static unsigned superword(const Statements &stmts, unsigned first)
+{
+    Expressions elements, bases, others;
+    vector<unsigned long> offsets;
+    unsigned long size, width, value;
+    Expression *base, *scaled;
+    Assignment *stmt;
+    unsigned count, i;
+    string opcode, other;
+    const Symbol *dest, *source;
+
+
+    /* Match the first statement of the run. */
+
+    stmt = dynamic_cast<Assignment *>(stmts[first]);
+
+    if (stmt == nullptr || !isElementwise(stmt, opcode, elements))
+	return 0;
+
+    size = elements[0]->type().size();
+    width = SIZEOF_VECTOR / size;
+
+    for (auto expr : elements) {
+	if (!isElement(expr, base, scaled) || !scaled->isNumber(value))
+	    return 0;
+
+	if (size == SIZEOF_CHAR && !baseSymbol(base)->type().isArray())
+	    return 0;
+
+	bases.push_back(base);
+	offsets.push_back(value);
+    }
+
+    dest = baseSymbol(bases[0]);
+
+    for (i = 1; i < bases.size(); i ++) {
+	source = baseSymbol(bases[i]);
+
+	if (source == dest) {
+	    if (offsets[0] > offsets[i] && offsets[0] - offsets[i] < SIZEOF_VECTOR)
+		return 0;
+
+	} else if (!source->type().isArray() || !dest->type().isArray())
+	    return 0;
+    }
+
+
+    /* Extend the run as long as each statement accesses the next element
+       of each of the arrays. */
+
+    for (count = 1; first + count < stmts.size(); count ++) {
+	stmt = dynamic_cast<Assignment *>(stmts[first + count]);
+
+	if (stmt == nullptr || !isElementwise(stmt, other, others))
+	    break;
+
+	if (other != opcode || others.size() != elements.size())
+	    break;
+
+	if (others[0]->type() != elements[0]->type())
+	    break;
+
+	for (i = 0; i < others.size(); i ++) {
+	    if (!isElement(others[i], base, scaled) || !scaled->isNumber(value))
+		break;
+
+	    if (baseSymbol(base) != baseSymbol(bases[i]))
+		break;
+
+	    if (base->type() != bases[i]->type())
+		break;
+
+	    if (value != offsets[i] + count * size)
+		break;
+	}
+
+	if (i < others.size())
+	    break;
+    }
+
+    count -= count % width;
+
+    if (count == 0)
+	return 0;
+
+
+    /* Load the bases into registers and generate the packed operations. */
+
+    cout << "# superword" << endl;
+
+    for (auto base : bases) {
+	base->generate();
+
+	if (base->_register == nullptr)
+	    load(base, getreg(base));
+    }
+
+    for (i = 0; i < count; i += width) {
+	cout << "\tmovdqu\t" << offsets[1] + i * size << "(";
+	cout << bases[1]->_register->name() << "), %xmm1" << endl;
+
+	if (bases.size() > 2) {
+	    cout << "\tmovdqu\t" << offsets[2] + i * size << "(";
+	    cout << bases[2]->_register->name() << "), %xmm2" << endl;
+	    cout << "\t" << packed(opcode, size) << "\t%xmm2, %xmm1" << endl;
+	}
+
+	cout << "\tmovdqu\t%xmm1, " << offsets[0] + i * size << "(";
+	cout << bases[0]->_register->name() << ")" << endl;
+    }
+
+    for (auto base : bases)
+	assign(base, nullptr);
+
+    return count;
+}
+
+
+/*
+ * Function:	vectorize (private)
+ *
+ * Description:	Attempt to generate an SSE2 vector loop for a counted loop
+ *		of one of the following forms:
+ *
+ *		    for (i = start; i < n; i = i + 1) a[i] = b[i] op c[i];
+ *		    for (i = start; i < n; i = i + 1) a[i] = b[i];
+ *		    for (i = start; i < n; i = i + 1) sum = sum + b[i];
+ *
+ *		where op is + or -, the elements are chars, ints, or longs,
+ *		and the counter is signed.  The vector loop handles as many
+ *		whole vectors as possible and then falls into the original
+ *		scalar loop, which finishes any remaining iterations.
+ *
+ *		The counter, the bound, and the bases are kept in registers
+ *		for the duration of the vector loop, so it is skipped at
+ *		run time if the destination could overwrite any of them,
+ *		or if a source overlaps the destination within a single
+ *		vector.
+ */
+
+static bool vectorize(Statement *init, Expression *test, Statement *incr,
+		      Statement *stmt, const Label &scalar)
+{
+    Assignment *start, *step, *body;
+    Identifier *counter, *total;
+    Expression *bound, *base, *scaled;
+    Expressions elements, bases, scalars;
+    Register *index, *limit, *lo, *len, *temp;
+    vector<Register *> temps;
+    unsigned long value, size, count;
+    const Symbol *symbol;
+    LessThan *compare;
+    Binary *binary;
+    Block *block;
+    string opcode;
+    Label loop, exit;
+
+
+    /* Match the loop itself: i = start; i < n; i = i + 1 */
+
+    start = dynamic_cast<Assignment *>(init);
+    step = dynamic_cast<Assignment *>(incr);
+    compare = dynamic_cast<LessThan *>(test);
+
+    if (start == nullptr || step == nullptr || compare == nullptr)
+	return false;
+
+    counter = dynamic_cast<Identifier *>(compare->left());
+    bound = compare->right();
+
+    if (counter == nullptr || !counter->type().isNumeric())
+	return false;
+
+    if (counter->type().size() < SIZEOF_INT || counter->type().isUnsigned())
+	return false;
+
+    symbol = counter->symbol();
+
+    if (!isCounter(start->left(), symbol) || !start->right()->isNumber(value))
+	return false;
+
+    if ((binary = dynamic_cast<Add *>(step->right())) == nullptr)
+	return false;
+
+    if (!isCounter(step->left(), symbol) || !isCounter(binary->left(), symbol))
+	return false;
+
+    if (!binary->right()->isNumber(value) || value != 1)
+	return false;
+
+    if (!bound->isNumber(value)) {
+	if (dynamic_cast<Identifier *>(bound) == nullptr || isCounter(bound, symbol))
+	    return false;
+
+	scalars.push_back(bound);
+    }
+
+    scalars.push_back(counter);
+
+
+    /* Match the body, which is a single assignment, possibly within a
+       specialized if statement of an unswitched loop. */
+
+    while ((block = dynamic_cast<Block *>(stmt = specialize(stmt))) != nullptr) {
+	if (block->statements().size() != 1)
+	    return false;
+
+	if (block->declarations()->symbols().size() != 0)
+	    return false;
+
+	stmt = block->statements()[0];
+    }
+
+    if ((body = dynamic_cast<Assignment *>(stmt)) == nullptr)
+	return false;
+
+    total = dynamic_cast<Identifier *>(body->left());
+
+    if (total != nullptr) {
+	if (isCounter(total, symbol) || isCounter(bound, total->symbol()))
+	    return false;
+
+	if (!total->type().isNumeric() || total->type().size() < SIZEOF_INT)
+	    return false;
+
+	if ((binary = dynamic_cast<Add *>(body->right())) == nullptr)
+	    return false;
+
+	if (isCounter(binary->left(), total->symbol()))
+	    elements.push_back(binary->right());
+	else if (isCounter(binary->right(), total->symbol()))
+	    elements.push_back(binary->left());
+	else
+	    return false;
+
+	if (elements[0]->type() != total->type())
+	    return false;
+
+	opcode = "add";
+
+    } else if (!isElementwise(body, opcode, elements))
+	return false;
+
+    size = elements[0]->type().size();
+
+    for (auto expr : elements) {
+	if (!isElement(expr, base, scaled))
+	    return false;
+
+	if (!isScaledCounter(scaled, symbol, size) || baseSymbol(base) == symbol)
+	    return false;
+
+	bases.push_back(base);
+    }
+
+
+    /* Load the counter, the bound, and the bases into registers. */
+
+    cout << "# vector loop" << endl;
+    count = SIZEOF_VECTOR / size;
+
+    widen(counter, index = getreg());
+    widen(bound, limit = getreg());
+
+    for (auto base : bases) {
+	base->generate();
+
+	if (base->_register == nullptr)
+	    load(base, getreg(base));
+    }
+
+    for (auto reg : registers)
+	if (reg->_node == nullptr)
+	    temps.push_back(reg);
+
+    assert(temps.size() >= 3);
+    lo = temps[0];
+    len = temps[1];
+    temp = temps[2];
+
+
+    /* Check that the store can't clobber the scalars that we're holding in
+       registers, nor a source within the same vector. */
+
+    if (total == nullptr) {
+	for (auto base : bases)
+	    if (dynamic_cast<Identifier *>(base) != nullptr)
+		scalars.push_back(base);
+
+	cout << "\tleaq\t(" << bases[0]->_register->name() << ",";
+	cout << index->name() << "," << size << "), " << lo->name() << endl;
+	cout << "\tmovq\t" << limit->name() << ", " << len->name() << endl;
+	cout << "\tsubq\t" << index->name() << ", " << len->name() << endl;
+
+	if (size > 1)
+	    cout << "\timulq\t$" << size << ", " << len->name() << endl;
+
+	for (auto expr : scalars) {
+	    cout << "\tleaq\t";
+	    expr->operand(cout);
+	    cout << ", " << temp->name() << endl;
+	    cout << "\tsubq\t" << lo->name() << ", " << temp->name() << endl;
+	    cout << "\tcmpq\t" << len->name() << ", " << temp->name() << endl;
+	    cout << "\tjb\t" << scalar << endl;
+	}
+
+	for (unsigned i = 1; i < bases.size(); i ++) {
+	    if (baseSymbol(bases[i]) == baseSymbol(bases[0]))
+		continue;
+
+	    if (baseSymbol(bases[i])->type().isArray())
+		if (baseSymbol(bases[0])->type().isArray())
+		    continue;
+
+	    cout << "\tmovq\t" << bases[0]->_register->name() << ", ";
+	    cout << temp->name() << endl;
+	    cout << "\tsubq\t" << bases[i]->_register->name() << ", ";
+	    cout << temp->name() << endl;
+	    cout << "\tsubq\t$1, " << temp->name() << endl;
+	    cout << "\tcmpq\t$" << SIZEOF_VECTOR - 1 << ", " << temp->name() << endl;
+	    cout << "\tjb\t" << scalar << endl;
+	}
+
+    } else
+	cout << "\tpxor\t%xmm0, %xmm0" << endl;
+
+
+    /* Generate the vector loop. */
+
+    cout << loop << ":" << endl;
+    forget();
+    cout << "\tleaq\t" << count << "(" << index->name() << "), ";
+    cout << temp->name() << endl;
+    cout << "\tcmpq\t" << limit->name() << ", " << temp->name() << endl;
+    cout << "\tjg\t" << exit << endl;
+
+    if (total != nullptr) {
+	cout << "\tmovdqu\t(" << bases[0]->_register->name() << ",";
+	cout << index->name() << "," << size << "), %xmm1" << endl;
+	cout << "\t" << packed(opcode, size) << "\t%xmm1, %xmm0" << endl;
+
+    } else {
+	cout << "\tmovdqu\t(" << bases[1]->_register->name() << ",";
+	cout << index->name() << "," << size << "), %xmm1" << endl;
+
+	if (bases.size() > 2) {
+	    cout << "\tmovdqu\t(" << bases[2]->_register->name() << ",";
+	    cout << index->name() << "," << size << "), %xmm2" << endl;
+	    cout << "\t" << packed(opcode, size) << "\t%xmm2, %xmm1" << endl;
+	}
+
+	cout << "\tmovdqu\t%xmm1, (" << bases[0]->_register->name() << ",";
+	cout << index->name() << "," << size << ")" << endl;
+    }
+
+    cout << "\taddq\t$" << count << ", " << index->name() << endl;
+    cout << "\tjmp\t" << loop << endl;
+    cout << exit << ":" << endl;
+    forget();
+    facts.clear();
+
+
+    /* Fold the partial sums together and add them to the total. */
+
+    if (total != nullptr) {
+	cout << "\tpshufd\t$78, %xmm0, %xmm1" << endl;
+	cout << "\t" << packed(opcode, size) << "\t%xmm1, %xmm0" << endl;
+
+	if (size == SIZEOF_INT) {
+	    cout << "\tpshufd\t$177, %xmm0, %xmm1" << endl;
+	    cout << "\t" << packed(opcode, size) << "\t%xmm1, %xmm0" << endl;
+	    cout << "\tmovd\t%xmm0, " << temp->name(size) << endl;
+	} else
+	    cout << "\tmovq\t%xmm0, " << temp->name(size) << endl;
+
+	cout << "\tadd" << suffix(size) << temp->name(size) << ", ";
+	total->operand(cout);
+	cout << endl;
+    }
+
+
+    /* Store the counter and release the registers. */
+
+    cout << "\tmov" << suffix(counter) << index->name(counter->type().size());
+    cout << ", ";
+    counter->operand(cout);
+    cout << endl;
+
+    assign(counter, nullptr);
+    assign(bound, nullptr);
+
+    for (auto base : bases)
+	assign(base, nullptr);
+
+    clobber(Location(counter));
+    clobber();
+
+    if (total != nullptr)
+	clobber(Location(total));
+
+    return true;
+}
+
+
+/*
+ * Function:	unroll (private)
+ *
+ * Description:	Attempt to unroll a counted loop of the form:
+ *
+ *		    for (i = start; i < n; i = i + 1) stmt
+ *
+ *		where the counter is a signed private variable not assigned
+ *		within the body, and the bound is either a constant or a
+ *		private variable that is also not assigned within the body.
+ *		An unsigned counter could wrap around when computing the
+ *		number of iterations remaining.
+ *
+ *		If both the start and the bound are constants and the whole
+ *		loop is small enough, it is fully unrolled.  Otherwise, the
+ *		body and increment are repeated within an unrolled loop
+ *		that runs while at least that many iterations remain,
+ *		followed by the remaining iterations, which are also
+ *		unrolled if their number is known, and otherwise are left
+ *		to the original loop.  Unless a factor is given, we repeat
+ *		the body as many times as fit within the unrolling limit,
+ *		up to eight times.  Only an innermost loop is unrolled this
+ *		way, since repeating a loop nest at every level would grow
+ *		the code, and the time to generate it, exponentially with
+ *		its depth.  We return whether the whole loop has been
+ *		generated.
+ */
+
+static bool unroll(Statement *init, Expression *test, Statement *incr,
+		   Statement *stmt)
+{
+    Assignment *start, *step;
+    Identifier *counter;
+    Expression *bound, *guard, *expr;
+    unsigned long value, first, last;
+    unsigned cost, factor;
+    long limit, trips;
+    const Symbol *symbol;
+    Substitution subst;
+    LessThan *compare;
+    Binary *binary;
+    Cast *cast;
+    Type type;
+    Label top, exit;
+
+
+    /* Match the loop itself: i = start; i < n; i = i + 1 */
+
+    start = dynamic_cast<Assignment *>(init);
+    step = dynamic_cast<Assignment *>(incr);
+    compare = dynamic_cast<LessThan *>(test);
+
+    if (unroll_limit == 0 || start == nullptr || step == nullptr)
+	return false;
+
+    if (compare == nullptr || stmt->returns())
+	return false;
+
+    counter = dynamic_cast<Identifier *>(compare->left());
+    bound = compare->right();
+
+    if (counter == nullptr || !counter->type().isNumeric())
+	return false;
+
+    type = counter->type();
+    symbol = counter->symbol();
+
+    if (type.size() < SIZEOF_INT || !Location(counter).isPrivate())
+	return false;
+
+    if (type.isUnsigned())
+	return false;
+
+    if (!isCounter(start->left(), symbol) || !isCounter(step->left(), symbol))
+	return false;
+
+    if ((binary = dynamic_cast<Add *>(step->right())) == nullptr)
+	return false;
+
+    if (!isCounter(binary->left(), symbol) || stmt->assigns(symbol))
+	return false;
+
+    if (!binary->right()->isNumber(value) || value != 1)
+	return false;
+
+    if (!bound->isNumber(value)) {
+	expr = bound;
+
+	if ((cast = dynamic_cast<Cast *>(expr)) != nullptr)
+	    expr = cast->expr();
+
+	if (dynamic_cast<Identifier *>(expr) == nullptr)
+	    return false;
+
+	if (isCounter(expr, symbol) || !Location(expr).isPrivate())
+	    return false;
+
+	if (stmt->assigns(static_cast<Identifier *>(expr)->symbol()))
+	    return false;
+    }
+
+
+    /* Fully unroll a small loop with a known number of iterations. */
+
+    cost = stmt->cost() + incr->cost();
+
+    if (start->right()->isNumber(first) && bound->isNumber(last)) {
+	trips = (long) last > (long) first ? (long) last - (long) first : 0;
+
+	if (trips * cost <= unroll_limit) {
+	    cout << "# unrolled loop" << endl;
+
+	    for (long i = 0; i < trips; i ++) {
+		stmt->generate();
+		incr->generate();
+	    }
+
+	    return true;
+	}
+
+    } else
+	trips = -1;
+
+
+    /* Otherwise, unroll the loop itself. */
+
+    if (stmt->loops())
+	return false;
+
+    factor = unroll_factor ? unroll_factor : unroll_limit / cost;
+
+    if (factor > 8 && unroll_factor == 0)
+	factor = 8;
+
+    while (unroll_factor == 0 && (factor & (factor - 1)) != 0)
+	factor &= factor - 1;
+
+    if (factor < 2)
+	return false;
+
+    if (bound->isNumber(last)) {
+	limit = (long) last - (factor - 1);
+
+	if (limit != (int) limit)
+	    return false;
+
+	guard = new LessThan(new Identifier(symbol), new Number(limit, type), Type(INT));
+
+    } else if (type.size() == SIZEOF_INT) {
+	expr = new Add(new Cast(new Identifier(symbol), Type(LONG)),
+		       new Number((long) factor - 1, Type(LONG)), Type(LONG));
+	guard = new LessThan(expr, new Cast(bound->clone(subst), Type(LONG)), Type(INT));
+
+    } else {
+	expr = new Add(new Identifier(symbol), new Number((long) factor - 1, type), type);
+	guard = new LessThan(expr, bound->clone(subst), Type(INT));
+    }
+
+    cout << "# unrolled loop" << endl;
+    loop(guard, stmt, incr, top, exit, factor);
+
+    if (trips < 0)
+	return false;
+
+    for (long i = 0; i < trips % factor; i ++) {
+	stmt->generate();
+	incr->generate();
+    }
+
+    return true;
+}
+
+
+/*
+ * Function:	isInvariant (private)
+ *
+ * Description:	Return whether the given expression has the same value
+ *		throughout a loop with the given body and increment, and
+ *		can be evaluated before the loop without any effect.  Such
+ *		an expression uses only numbers and private variables not
+ *		assigned within the loop, and has no division that could
+ *		fault.
+ */
+
+static bool isInvariant(Expression *expr, Statement *stmt, Statement *incr)
+{
+    const Symbol *symbol;
+    unsigned long value;
+    Binary *binary;
+    Unary *unary;
+
+
+    if (expr->isNumber(value))
+	return true;
+
+    if (expr->isIdentifier(symbol)) {
+	if (!Location(expr).isPrivate() || stmt->assigns(symbol))
+	    return false;
+
+	return incr == nullptr || !incr->assigns(symbol);
+    }
+
+    if (dynamic_cast<Divide *>(expr) != nullptr)
+	return false;
+
+    if (dynamic_cast<Remainder *>(expr) != nullptr)
+	return false;
+
+    if ((binary = dynamic_cast<Binary *>(expr)) != nullptr) {
+	if (!isInvariant(binary->left(), stmt, incr))
+	    return false;
+
+	return isInvariant(binary->right(), stmt, incr);
+    }
+
+    if ((unary = dynamic_cast<Unary *>(expr)) != nullptr) {
+	if (dynamic_cast<Dereference *>(expr) != nullptr)
+	    return false;
+
+	return isInvariant(unary->expr(), stmt, incr);
+    }
+
+    return false;
+}
+
+
+/*
+ * Function:	specialize (private)
+ *
+ * Description:	Return the statement that is actually generated for the
+ *		given statement, which is the branch taken if it is an if
+ *		statement specialized by unswitching.
+ */
+
+static Statement *specialize(Statement *stmt)
+{
+    If *branch;
+
+
+    while ((branch = dynamic_cast<If *>(stmt)) != nullptr) {
+	auto entry = specialized.find(branch);
+
+	if (entry == specialized.end())
+	    break;
+
+	stmt = entry->second ? branch->thenStmt() : branch->elseStmt();
+    }
+
+    return stmt;
+}
+
+
+/*
+ * Function:	findInvariant (private)
+ *
+ * Description:	Return an if statement within the given statement whose
+ *		test is invariant in a loop with the given body and
+ *		increment, or null if there is none.  Only statements
+ *		executed directly by the body are considered.
+ */
+
+static If *findInvariant(Statement *stmt, Statement *body, Statement *incr)
+{
+    unsigned long value;
+    Block *block;
+    If *branch;
+
+
+    stmt = specialize(stmt);
+
+    if ((branch = dynamic_cast<If *>(stmt)) != nullptr) {
+	if (branch->expr()->isNumber(value))
+	    return nullptr;
+
+	return isInvariant(branch->expr(), body, incr) ? branch : nullptr;
+    }
+
+    if ((block = dynamic_cast<Block *>(stmt)) != nullptr)
+	for (auto stmt : block->statements())
+	    if ((branch = findInvariant(stmt, body, incr)) != nullptr)
+		return branch;
+
+    return nullptr;
+}
+
+
+/*
+ * Function:	unswitch (private)
+ *
+ * Description:	Attempt to unswitch a loop containing an if statement
+ *		whose test is invariant.  The test is evaluated once before
+ *		the loop, which is then generated twice, once with the if
+ *		statement always taking its then branch and once with it
+ *		always taking its else branch.  Each copy may itself be
+ *		unswitched, vectorized, or unrolled.  The total size of the
+ *		copies of any one loop is limited.
+ */
+
+static bool unswitch(Statement *init, Expression *expr, Statement *incr,
+		     Statement *stmt)
+{
+    static unsigned copies = 1;
+    State branch, thenState;
+    unsigned cost;
+    Label other, exit;
+    If *invariant;
+
+
+    if ((invariant = findInvariant(stmt, stmt, incr)) == nullptr)
+	return false;
+
+    cost = expr->cost() + stmt->cost() + (incr ? incr->cost() : 0);
+
+    if (cost * copies * 2 > unswitch_limit)
+	return false;
+
+    cout << "# unswitched loop" << endl;
+    invariant->expr()->test(other, false);
+    branch = save();
+    copies *= 2;
+
+    specialized[invariant] = true;
+    iterate(init, expr, incr, stmt);
+    cout << "\tjmp\t" << exit << endl;
+    thenState = save();
+
+    cout << other << ":" << endl;
+    restore(branch);
+    specialized[invariant] = false;
+    iterate(init, expr, incr, stmt);
+
+    cout << exit << ":" << endl;
+    restore(meet(thenState, save()));
+    specialized.erase(invariant);
+    copies /= 2;
+    return true;
+}
+
+
+/*
+ * Function:	iterate (private)
+ *
+ * Description:	Generate code for a loop once its initialization, if any,
+ *		has been generated.  The loop is unswitched if possible,
+ *		and otherwise a counted loop may first be vectorized, or
+ *		else unrolled.
+ */
+
+static void iterate(Statement *init, Expression *expr, Statement *incr,
+		    Statement *stmt)
+{
+    Label top, exit;
+
+
+    if (unswitch(init, expr, incr, stmt))
+	return;
+
+    if (!vectorize(init, expr, incr, stmt, top))
+	if (unroll(init, expr, incr, stmt))
+	    return;
+
+    loop(expr, stmt, incr, top, exit);
+}
+
+
 void For::generate(){
     cout << "# for" <<endl;
-    Label loop, exit;
+    unsigned long value;
     _init->generate();
-    cout << loop << ":" << endl;
-    _expr->test(exit, false);
-    _stmt->generate();
-    _incr->generate();
 
-    cout << "\tjmp\t" << loop << endl;
-    cout << exit << ":" << endl;
+    if (dce && _expr->isNumber(value) && value == 0)
+        return;
+
+    iterate(_init, _expr, _incr, _stmt);
+}
+
+/*
+ * Function:	speculable (private)
+ *
+ * Description:	Return whether the given expression may be evaluated even
+ *		if the program would not have evaluated it.  It must have no
+ *		effects, cannot fault or trap, and must not branch.
+ */
+
+static bool speculable(Expression *expr)
+{
+    Expression *pointer;
+    Unary *unary;
+    Binary *binary;
+
+
+    if (expr->isDereference(pointer) || !expr->pure())
+	return false;
+
+    if (dynamic_cast<Divide *>(expr) != nullptr)
+	return false;
+
+    if (dynamic_cast<Remainder *>(expr) != nullptr)
+	return false;
+
+    if (dynamic_cast<LogicalAnd *>(expr) != nullptr)
+	return false;
+
+    if (dynamic_cast<LogicalOr *>(expr) != nullptr)
+	return false;
+
+    if ((unary = dynamic_cast<Unary *>(expr)) != nullptr)
+	return speculable(unary->expr());
+
+    if ((binary = dynamic_cast<Binary *>(expr)) != nullptr)
+	return speculable(binary->left()) && speculable(binary->right());
+
+    return true;
+}
+
+
+/*
+ * Function:	assignment (private)
+ *
+ * Description:	Return the given statement if it is an assignment, or a
+ *		block containing only an assignment, and otherwise a null
+ *		pointer.
+ */
+
+static Assignment *assignment(Statement *stmt)
+{
+    Block *block;
+
+
+    if ((block = dynamic_cast<Block *>(stmt)) != nullptr) {
+	if (block->statements().size() != 1)
+	    return nullptr;
+
+	stmt = block->statements()[0];
+    }
+
+    return dynamic_cast<Assignment *>(stmt);
+}
+
+
+/*
+ * Function:	predicate (private)
+ *
+ * Description:	Attempt to generate an if statement as a conditional move.
+ *		Each branch must assign to the same variable, a missing
+ *		else branch leaving it unchanged, and the values assigned
+ *		must be safe to compute regardless of the test, since both
+ *		are computed before the test chooses one.  Nor may the test
+ *		itself branch, or the flags would be lost.  This trades a
+ *		branch, which may be mispredicted, for computing both
+ *		values, so their total cost is limited.  There is no
+ *		conditional move of a byte.
+ */
+
+static bool predicate(Expression *test, Statement *thenStmt,
+		      Statement *elseStmt)
+{
+    Assignment *first, *second;
+    Expression *chosen, *other, *left, *right;
+    const Symbol *symbol, *symbol2;
+    Binary *compare;
+    unsigned long value;
+    Register *reg;
+    unsigned size;
+    string cc;
+
+
+    if (cmov_limit == 0 || (first = assignment(thenStmt)) == nullptr)
+	return false;
+
+    if (!first->left()->isIdentifier(symbol) || (dce && first->dead()))
+	return false;
+
+    second = nullptr;
+
+    if (elseStmt != nullptr) {
+	if ((second = assignment(elseStmt)) == nullptr)
+	    return false;
+
+	if (!second->left()->isIdentifier(symbol2) || symbol2 != symbol)
+	    return false;
+
+	if (dce && second->dead())
+	    return false;
+    }
+
+    size = first->left()->type().size();
+
+    if (!first->left()->type().isScalar() || (size != 4 && size != 8))
+	return false;
+
+    Identifier current(symbol);
+    chosen = first->right();
+    other = (second != nullptr ? second->right() : &current);
+
+    if (chosen->type().size() != size || other->type().size() != size)
+	return false;
+
+    if (!speculable(chosen) || !speculable(other) || !speculable(test))
+	return false;
+
+    if (chosen->cost() + other->cost() > cmov_limit)
+	return false;
+
+
+    /* Find the condition code for the test.  A comparison is made
+       directly, and any other test is compared against zero. */
+
+    compare = dynamic_cast<Binary *>(test);
+
+    if (dynamic_cast<LessThan *>(test) != nullptr)
+	cc = "l";
+    else if (dynamic_cast<GreaterThan *>(test) != nullptr)
+	cc = "g";
+    else if (dynamic_cast<LessOrEqual *>(test) != nullptr)
+	cc = "le";
+    else if (dynamic_cast<GreaterOrEqual *>(test) != nullptr)
+	cc = "ge";
+    else if (dynamic_cast<Equal *>(test) != nullptr)
+	cc = "e";
+    else if (dynamic_cast<NotEqual *>(test) != nullptr)
+	cc = "ne";
+    else
+	compare = nullptr;
+
+    if (compare != nullptr)
+	cc = condition(cc, compare->left()->type());
+
+
+    /* Compute both values and the operands of the test, and only then
+       compare, since the arithmetic would change the flags. */
+
+    cout << "# conditional move" << endl;
+    other->generate();
+    chosen->generate();
+
+    if (compare != nullptr) {
+	left = compare->left();
+	right = compare->right();
+	left->generate();
+	right->generate();
+    } else {
+	left = test;
+	right = nullptr;
+	test->generate();
+    }
+
+    if (other->_register == nullptr)
+	load(other, getreg());
+
+    if (chosen->_register == nullptr && chosen->isNumber(value))
+	load(chosen, getreg());
+    else
+	fetch(chosen);
+
+    if (right != nullptr)
+	fetch(right);
+
+    if (left->_register == nullptr)
+	load(left, getreg(left));
+
+    if (right != nullptr) {
+	cout << "\tcmp" << suffix(left) << right << ", " << left << endl;
+	assign(right, nullptr);
+    } else {
+	cout << "\tcmp" << suffix(left) << "$0, " << left << endl;
+	cc = "ne";
+    }
+
+    assign(left, nullptr);
+    reg = other->_register;
+    cout << "\tcmov" << cc << "\t" << chosen << ", " << reg->name(size) << endl;
+
+    assign(chosen, nullptr);
+    assign(other, nullptr);
+    values[reg].clear();
+
+    cout << "\tmov" << suffix(size) << reg->name(size) << ", ";
+    cout << first->left() << endl;
+    clobber(Location(first->left()));
+
+    if (cse)
+	values[reg].insert(first->left()->key());
+
+    return true;
+}
+
+
+/*
+ * Function:	thread (private)
+ *
+ * Description:	Attempt to thread the jumps from an if statement in the
+ *		given statements over the statements that follow it, up to
+ *		and including the next if statement.  If the outcome of
+ *		that later test is known at the end of each branch of the
+ *		first, then the statements in between are duplicated at
+ *		the end of each branch, and each copy of the later if
+ *		statement goes straight to the branch that it would take.
+ *		The code is generated into a buffer and discarded if any
+ *		copy of the test is not decided.  The total size of the
+ *		statements duplicated is limited.  Return the number of
+ *		statements generated.
+ */
+
+static Statements threaded;
+static const If *watched;
+static unsigned decisions, continued;
+
+static unsigned thread(const Statements &stmts, unsigned first)
+{
+    Statements savedThreaded;
+    const If *savedWatched;
+    unsigned savedDecisions, savedContinued, cost, last;
+    ostringstream buffer;
+    streambuf *saved;
+    State entry;
+    bool valid;
+    int start;
+
+
+    if (thread_limit == 0 || dynamic_cast<If *>(stmts[first]) == nullptr)
+	return 0;
+
+    for (last = first + 1, cost = 0; last < stmts.size(); last ++) {
+	cost += stmts[last]->cost();
+
+	if (cost > thread_limit)
+	    return 0;
+
+	if (dynamic_cast<If *>(stmts[last]) != nullptr)
+	    break;
+    }
+
+    if (last == stmts.size())
+	return 0;
+
+    savedThreaded = threaded;
+    savedWatched = watched;
+    savedDecisions = decisions;
+    savedContinued = continued;
+
+    threaded.assign(stmts.begin() + first + 1, stmts.begin() + last + 1);
+    watched = static_cast<If *>(stmts[last]);
+    decisions = continued = 0;
+
+    entry = save();
+    start = offset;
+    saved = cout.rdbuf(buffer.rdbuf());
+    stmts[first]->generate();
+    cout.rdbuf(saved);
+
+    valid = continued > 0 && decisions == continued;
+
+    threaded = savedThreaded;
+    watched = savedWatched;
+    decisions = savedDecisions;
+    continued = savedContinued;
+
+    if (!valid) {
+	restore(entry);
+	offset = start;
+	return 0;
+    }
+
+    cout << "# threaded" << endl;
+    cout << buffer.str();
+    return last - first + 1;
 }
 
+
+/*
+ * Function:	If::generate
+ *
+ * Description:	Generate code for an if statement.  If the outcome of the
+ *		test is already known, only the branch taken is generated,
+ *		and otherwise the outcome is known within each branch.  Any
+ *		statements being threaded are generated at the end of each
+ *		branch that reaches its end.
+ */
+
 void If::generate(){
     cout << "# if" <<endl;
     Label then, elseblk, exit;
+    unsigned long value;
+    Statements next;
+    bool truth;
+
+    State branch, thenState, elseState;
+    auto entry = specialized.find(this);
+
+    next.swap(threaded);
+
+    if (entry != specialized.end()) {
+        if (entry->second)
+            _thenStmt->generate();
+        else if (_elseStmt != nullptr)
+            _elseStmt->generate();
+
+        return;
+    }
+
+    if (dce && _expr->isNumber(value)) {
+        if (value != 0)
+            _thenStmt->generate();
+        else if (_elseStmt != nullptr)
+            _elseStmt->generate();
+
+        return;
+    }
+
+    if (thread_limit > 0 && decide(_expr, truth)) {
+        cout << "# decided" << endl;
+
+        if (this == watched)
+            decisions ++;
+
+        if (truth)
+            _thenStmt->generate();
+        else if (_elseStmt != nullptr)
+            _elseStmt->generate();
+
+        return;
+    }
+
+    if (next.empty() && predicate(_expr, _thenStmt, _elseStmt))
+        return;
 
     _expr->test(then, true);
     cout << "\tjmp\t" << elseblk << endl;
+    branch = save();
 
     cout << then << ":\n";
     cout << "# then" <<endl;
+
+    if (thread_limit > 0)
+        assume(_expr, true);
+
     _thenStmt->generate();
+
+    if (!next.empty() && !_thenStmt->returns()) {
+        continued ++;
+
+        for (auto stmt : next)
+            stmt->generate();
+    }
+
     cout << "\tjmp\t" << exit << endl;
+    thenState = save();
 
     cout << elseblk << ":\n";
+    restore(branch);
     cout << "# else" <<endl;
+
+    if (thread_limit > 0)
+        assume(_expr, false);
+
     if(_elseStmt != nullptr)
         _elseStmt->generate();
+
+    if (!next.empty() && (_elseStmt == nullptr || !_elseStmt->returns())) {
+        continued ++;
+
+        for (auto stmt : next)
+            stmt->generate();
+    }
     
     cout << "\tjmp\t" << exit << endl;
+    elseState = save();
 
     cout << exit << ":\n";
 
-}
\ No newline at end of file
+    if (_thenStmt->returns())
+        restore(elseState);
+    else if (_elseStmt != nullptr && _elseStmt->returns())
+        restore(thenState);
+    else
+        restore(meet(thenState, elseState));
+
+}
+
+/*
+ * Function:	fits (private)
+ *
+ * Description:	Return whether the given value fits in an immediate
+ *		operand.
+ */
+
+static bool fits(long value)
+{
+    return value == (int) value;
+}
+
+
+/*
+ * Function:	compare (private)
+ *
+ * Description:	Compare the given expression, which is in a register, with
+ *		the given value.  Any value of a type smaller than a long
+ *		fits in an immediate operand.
+ */
+
+static void compare(Expression *expr, long value)
+{
+    Register *reg;
+
+
+    if (fits(value) || expr->type().size() < SIZEOF_LONG) {
+	cout << "\tcmp" << suffix(expr) << "$" << value << ", " << expr << endl;
+	return;
+    }
+
+    reg = getreg();
+    cout << "\tmovabsq\t$" << value << ", " << reg->name() << endl;
+    cout << "\tcmpq\t" << reg->name() << ", " << expr << endl;
+    values[reg].clear();
+}
+
+
+/*
+ * Function:	search (private)
+ *
+ * Description:	Generate a binary search of the given sorted cases, from
+ *		the first up to but excluding the last, for the value of
+ *		the given expression.  A few cases are simply compared in
+ *		turn.
+ */
+
+static void search(Expression *expr, const vector<pair<long, unsigned>> &cases,
+		   unsigned first, unsigned last, const vector<Label> &labels,
+		   const Label &otherwise)
+{
+    unsigned middle;
+    Label less;
+
+
+    if (last - first <= 3) {
+	for (unsigned i = first; i < last; i ++) {
+	    compare(expr, cases[i].first);
+	    cout << "\tje\t" << labels[cases[i].second] << endl;
+	}
+
+	cout << "\tjmp\t" << otherwise << endl;
+	return;
+    }
+
+    middle = (first + last) / 2;
+    compare(expr, cases[middle].first);
+    cout << "\tje\t" << labels[cases[middle].second] << endl;
+    cout << "\tj" << condition("l", expr->type()) << "\t" << less << endl;
+    search(expr, cases, middle + 1, last, labels, otherwise);
+
+    cout << less << ":" << endl;
+    search(expr, cases, first, middle, labels, otherwise);
+}
+
+
+/*
+ * Function:	dispatch (private)
+ *
+ * Description:	Generate code to jump to the label of the case matching
+ *		the value of the given expression, or to the other label if
+ *		there is none, choosing a method by the density of the
+ *		cases.  If the cases span less than a word and lead to only
+ *		a few labels, then a mask of the cases leading to each
+ *		label is tested using the value as a bit index.  Otherwise,
+ *		if the cases are dense, the value indexes a table of labels
+ *		in read-only data.  Otherwise, a binary search compares the
+ *		value against the cases.  The cases of an unsigned long are
+ *		first put in unsigned order.
+ */
+
+static void dispatch(Expression *expr, const Cases &cases,
+		     const vector<Label> &labels, const Label &otherwise)
+{
+    vector<pair<long, unsigned>> sorted;
+    map<unsigned, unsigned long> masks;
+    Register *index, *temp;
+    unsigned long range;
+    long low, high, base;
+    unsigned count;
+    bool dense;
+    Label table;
+
+
+    for (auto &entry : cases)
+	if (entry.first >= 0 || !expr->type().isUnsigned())
+	    sorted.push_back(entry);
+
+    for (auto &entry : cases)
+	if (entry.first < 0 && expr->type().isUnsigned())
+	    sorted.push_back(entry);
+
+    expr->generate();
+    fetch(expr);
+    count = cases.size();
+
+    if (count == 0) {
+	assign(expr, nullptr);
+	cout << "\tjmp\t" << otherwise << endl;
+	return;
+    }
+
+    low = sorted.front().first;
+    high = sorted.back().first;
+    range = (unsigned long) high - low + 1;
+    dense = jump_tables && fits(low) && fits(high) && low <= high;
+    base = (low >= 0 && high < 64 ? 0 : low);
+
+    if (dense && range <= 64)
+	for (auto &entry : sorted)
+	    masks[entry.second] |= 1UL << (entry.first - base);
+
+
+    /* Test the bits of a mask for each label. */
+
+    if ((masks.size() == 1 && count >= 3) ||
+	(masks.size() == 2 && count >= 5) ||
+	(masks.size() == 3 && count >= 6)) {
+	cout << "# bit tests" << endl;
+	widen(expr, index = getreg());
+	values[index].clear();
+	temp = getreg();
+
+	if (base != 0)
+	    cout << "\tsubq\t$" << base << ", " << index->name() << endl;
+
+	cout << "\tcmpq\t$" << high - base << ", " << index->name() << endl;
+	cout << "\tja\t" << otherwise << endl;
+
+	for (auto &entry : masks) {
+	    if (fits(entry.second))
+		cout << "\tmovq\t$" << entry.second << ", " << temp->name() << endl;
+	    else
+		cout << "\tmovabsq\t$" << entry.second << ", " << temp->name() << endl;
+
+	    cout << "\tbtq\t" << index->name() << ", " << temp->name() << endl;
+	    cout << "\tjc\t" << labels[entry.first] << endl;
+	}
+
+	cout << "\tjmp\t" << otherwise << endl;
+	values[temp].clear();
+	assign(expr, nullptr);
+	return;
+    }
+
+
+    /* Index a table of labels. */
+
+    if (dense && count >= 4 && range <= 4 * count && range <= table_limit) {
+	cout << "# jump table" << endl;
+	widen(expr, index = getreg());
+	values[index].clear();
+
+	if (low != 0)
+	    cout << "\tsubq\t$" << low << ", " << index->name() << endl;
+
+	cout << "\tcmpq\t$" << range - 1 << ", " << index->name() << endl;
+	cout << "\tja\t" << otherwise << endl;
+	cout << "\tjmp\t*" << table << "(," << index->name() << ",8)" << endl;
+
+	cout << const_section << endl;
+	cout << "\t.align\t8" << endl;
+	cout << table << ":" << endl;
+
+	for (unsigned long i = 0; i < range; i ++) {
+	    auto entry = cases.find(low + i);
+	    cout << "\t.quad\t";
+	    cout << (entry != cases.end() ? labels[entry->second] : otherwise);
+	    cout << endl;
+	}
+
+	cout << "\t.text" << endl;
+	assign(expr, nullptr);
+	return;
+    }
+
+
+    /* Search the cases. */
+
+    cout << "# binary search" << endl;
+
+    if (expr->_register == nullptr)
+	load(expr, getreg(expr));
+
+    search(expr, sorted, 0, count, labels, otherwise);
+    assign(expr, nullptr);
+}
+
+
+/*
+ * Function:	Switch::generate
+ *
+ * Description:	Generate code for a switch statement.  The value is first
+ *		dispatched to the label of its case, or to the default,
+ *		which is the end of the switch if there is none.  The
+ *		statements are then generated in order, with control
+ *		falling from each into the next.  The state at a label is
+ *		the state after the dispatch met with the state falling
+ *		into it, and at a label with a single case and nothing
+ *		falling into it, the value is known.  Any statements not
+ *		reached from a label are never executed.  The state at the
+ *		end is met with the state at each break.
+ */
+
+static const Label *breakLabel;
+static State broken;
+static bool breaking;
+
+void Switch::generate()
+{
+    vector<Label> labels(_stmts.size() + 1);
+    const Label *savedLabel;
+    State entry, savedBroken;
+    bool savedBreaking, reached;
+    unsigned long value;
+    unsigned i, count;
+    long single;
+    string key;
+
+
+    cout << "# switch" << endl;
+
+    if (_expr->isNumber(value)) {
+	auto entry = _cases.find(_expr->type().normalize(value));
+	i = (entry != _cases.end() ? entry->second : _default);
+	cout << "\tjmp\t" << labels[i] << endl;
+    } else {
+	key = _expr->key();
+	dispatch(_expr, _cases, labels, labels[_default]);
+    }
+
+    entry = save();
+    savedLabel = breakLabel;
+    savedBroken = broken;
+    savedBreaking = breaking;
+    breakLabel = &labels[_stmts.size()];
+    breaking = reached = false;
+
+    for (i = 0; i <= _stmts.size(); i ++) {
+	if (labeled(i)) {
+	    cout << labels[i] << ":" << endl;
+
+	    if (!reached) {
+		restore(entry);
+		count = 0;
+
+		for (auto &label : _cases)
+		    if (label.second == i) {
+			single = label.first;
+			count ++;
+		    }
+
+		if (thread_limit > 0 && !key.empty() && count == 1 && _default != i)
+		    facts[key] = single;
+	    } else
+		restore(meet(save(), entry));
+
+	    reached = true;
+	} else if (i == _stmts.size())
+	    cout << labels[i] << ":" << endl;
+
+	if (i == _stmts.size() || !reached)
+	    continue;
+
+	_stmts[i]->generate();
+
+	for (auto reg : registers)
+	    assert(reg->_node == nullptr);
+
+	reached = !_stmts[i]->returns();
+    }
+
+    if (breaking)
+	restore(reached ? meet(save(), broken) : broken);
+
+    breakLabel = savedLabel;
+    broken = savedBroken;
+    breaking = savedBreaking;
+}
+
+
+/*
+ * Function:	Break::generate
+ *
+ * Description:	Generate code for a break statement, which jumps to the
+ *		end of the switch statement.  The state there must account
+ *		for the state here.
+ */
+
+void Break::generate()
+{
+    cout << "\tjmp\t" << *breakLabel << endl;
+    broken = (breaking ? meet(broken, save()) : save());
+    breaking = true;
+}
@@ -0,0 +1,476 @@
+/*
+ * File:	inliner.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		copying abstract syntax trees, and the public functions for
+ *		inlining calls to small functions.
+ *
+ *		A call is inlined when it is checked, so only functions
+ *		defined earlier in the translation unit can be inlined.
+ *		The body of the function is copied with new symbols for its
+ *		parameters and local variables, and the arguments are
+ *		assigned to the new parameters.  A return within the copy
+ *		stores its value in a new local variable and jumps to the
+ *		end of the copy.  A function is only inlined if its body is
+ *		small enough, and the total growth of any one function due
+ *		to inlining is limited by a budget.
+ */
+
+# include "inliner.h"
+# include "options.h"
+# include "tokens.h"
+
+using namespace std;
+
+static map<const Symbol *, const Function *> functions;
+static unsigned spent;
+
+
+/*
+ * Function:	recordFunction
+ *
+ * Description:	Record the definition of a function so that any later
+ *		calls to it may be inlined.  Since functions are recorded
+ *		once they have been completely checked, this function also
+ *		resets the budget for the next function.
+ */
+
+void recordFunction(const Function *function)
+{
+    functions[function->id()] = function;
+    spent = 0;
+}
+
+
+/*
+ * Function:	inlineCall
+ *
+ * Description:	Attempt to inline a call to the given function with the
+ *		given arguments, which have already been converted to the
+ *		types of the parameters.  An inlined call is returned if
+ *		successful, and a null pointer is returned otherwise.
+ */
+
+Expression *inlineCall(const Symbol *id, const Expressions &args, const Type &type)
+{
+    const Function *function;
+    Parameters *params;
+    Statements stmts;
+    Substitution subst;
+    Symbol *result;
+    Block *body;
+    unsigned cost;
+
+
+    if (functions.count(id) == 0)
+	return nullptr;
+
+    function = functions[id];
+    params = id->type().parameters();
+    cost = function->body()->cost();
+
+    if (params == nullptr || params->size() != args.size())
+	return nullptr;
+
+    if (cost > inline_limit || spent + cost > inline_budget)
+	return nullptr;
+
+
+    /* Copy the body and assign the arguments to the new parameters. */
+
+    const Symbols &symbols = function->body()->declarations()->symbols();
+    body = static_cast<Block *>(function->body()->clone(subst));
+
+    for (unsigned i = 0; i < args.size(); i ++)
+	stmts.push_back(new Assignment(new Identifier(subst[symbols[i]]), args[i]));
+
+    for (auto stmt : body->statements())
+	stmts.push_back(stmt);
+
+
+    /* Add a new local variable to hold the return value. */
+
+    result = nullptr;
+
+    if (type.specifier() != VOID || type.indirection() > 0) {
+	result = new Symbol(id->name() + ".result", type);
+	body->declarations()->insert(result);
+    }
+
+    spent += cost;
+    return new Inline(id, new Block(body->declarations(), stmts), result, type);
+}
+
+
+/*
+ * Function:	Node::cost
+ *
+ * Description:	Return an estimate of the size of the code generated for
+ *		this node, which is simply its number of nodes.
+ */
+
+unsigned Node::cost() const
+{
+    return 1;
+}
+
+
+/*
+ * The remaining cost functions simply add up the costs of the children of
+ * each node, and aren't very interesting.
+ */
+
+unsigned Unary::cost() const
+{
+    return 1 + _expr->cost();
+}
+
+unsigned Binary::cost() const
+{
+    return 1 + _left->cost() + _right->cost();
+}
+
+unsigned Call::cost() const
+{
+    unsigned total = 1;
+
+    for (auto arg : _args)
+	total += arg->cost();
+
+    return total;
+}
+
+unsigned Inline::cost() const
+{
+    return _body->cost();
+}
+
+unsigned Assignment::cost() const
+{
+    return 1 + _left->cost() + _right->cost();
+}
+
+unsigned Return::cost() const
+{
+    return 1 + _expr->cost();
+}
+
+unsigned Block::cost() const
+{
+    unsigned total = 0;
+
+    for (auto stmt : _stmts)
+	total += stmt->cost();
+
+    return total;
+}
+
+unsigned While::cost() const
+{
+    return 1 + _expr->cost() + _stmt->cost();
+}
+
+unsigned For::cost() const
+{
+    return 1 + _init->cost() + _expr->cost() + _incr->cost() + _stmt->cost();
+}
+
+unsigned If::cost() const
+{
+    unsigned total = 1 + _expr->cost() + _thenStmt->cost();
+
+    if (_elseStmt != nullptr)
+	total += _elseStmt->cost();
+
+    return total;
+}
+
+unsigned Switch::cost() const
+{
+    unsigned total = 1 + _expr->cost();
+
+    for (auto stmt : _stmts)
+	total += stmt->cost();
+
+    return total;
+}
+
+unsigned Simple::cost() const
+{
+    return _expr->cost();
+}
+
+
+/*
+ * Function:	Block::clone
+ *
+ * Description:	Return a copy of this block.  New symbols are created for
+ *		all symbols declared within the block, and any references
+ *		to them within the copy are replaced by references to the
+ *		new symbols.
+ */
+
+Statement *Block::clone(Substitution &subst) const
+{
+    Scope *decls;
+    Statements stmts;
+    Symbol *symbol;
+
+
+    decls = new Scope();
+
+    for (auto old : _decls->symbols()) {
+	symbol = new Symbol(old->name(), old->type());
+	symbol->_addressed = old->_addressed;
+	decls->insert(symbol);
+	subst[old] = symbol;
+    }
+
+    for (auto stmt : _stmts)
+	stmts.push_back(stmt->clone(subst));
+
+    return new Block(decls, stmts);
+}
+
+
+/*
+ * Function:	Identifier::clone
+ *
+ * Description:	Return a copy of this identifier, substituting its symbol
+ *		if it was declared within the tree being copied.
+ */
+
+Expression *Identifier::clone(Substitution &subst) const
+{
+    if (subst.count(_symbol) > 0)
+	return new Identifier(subst[_symbol]);
+
+    return new Identifier(_symbol);
+}
+
+
+/*
+ * Function:	Number::clone
+ *
+ * Description:	Return a copy of this number.  We can't simply construct
+ *		a new number from its value, since the type of a number
+ *		depends on how it was constructed.
+ */
+
+Expression *Number::clone(Substitution &subst) const
+{
+    Number *copy = new Number(*this);
+
+    copy->_offset = 0;
+    copy->_register = nullptr;
+    return copy;
+}
+
+
+/*
+ * Function:	Inline::clone
+ *
+ * Description:	Return a copy of this inlined call, along with the local
+ *		variable that holds its return value.
+ */
+
+Expression *Inline::clone(Substitution &subst) const
+{
+    Block *body = static_cast<Block *>(_body->clone(subst));
+    return new Inline(_id, body, _result ? subst[_result] : nullptr, _type);
+}
+
+
+/*
+ * The remaining clone functions simply copy their children and construct
+ * a new node of the same kind.
+ */
+
+Expression *String::clone(Substitution &subst) const
+{
+    return new String(_value);
+}
+
+Expression *Call::clone(Substitution &subst) const
+{
+    Expressions args;
+
+    for (auto arg : _args)
+	args.push_back(arg->clone(subst));
+
+    return new Call(_id, args, _type);
+}
+
+Expression *Not::clone(Substitution &subst) const
+{
+    return new Not(_expr->clone(subst), _type);
+}
+
+Expression *Negate::clone(Substitution &subst) const
+{
+    return new Negate(_expr->clone(subst), _type);
+}
+
+Expression *Complement::clone(Substitution &subst) const
+{
+    return new Complement(_expr->clone(subst), _type);
+}
+
+Expression *Dereference::clone(Substitution &subst) const
+{
+    return new Dereference(_expr->clone(subst), _type);
+}
+
+Expression *Address::clone(Substitution &subst) const
+{
+    return new Address(_expr->clone(subst), _type);
+}
+
+Expression *Cast::clone(Substitution &subst) const
+{
+    return new Cast(_expr->clone(subst), _type);
+}
+
+Expression *Multiply::clone(Substitution &subst) const
+{
+    return new Multiply(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *Divide::clone(Substitution &subst) const
+{
+    return new Divide(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *Remainder::clone(Substitution &subst) const
+{
+    return new Remainder(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *Add::clone(Substitution &subst) const
+{
+    return new Add(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *Subtract::clone(Substitution &subst) const
+{
+    return new Subtract(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *LeftShift::clone(Substitution &subst) const
+{
+    return new LeftShift(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *RightShift::clone(Substitution &subst) const
+{
+    return new RightShift(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *LessThan::clone(Substitution &subst) const
+{
+    return new LessThan(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *GreaterThan::clone(Substitution &subst) const
+{
+    return new GreaterThan(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *LessOrEqual::clone(Substitution &subst) const
+{
+    return new LessOrEqual(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *GreaterOrEqual::clone(Substitution &subst) const
+{
+    return new GreaterOrEqual(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *Equal::clone(Substitution &subst) const
+{
+    return new Equal(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *NotEqual::clone(Substitution &subst) const
+{
+    return new NotEqual(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *BitwiseAnd::clone(Substitution &subst) const
+{
+    return new BitwiseAnd(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *BitwiseXor::clone(Substitution &subst) const
+{
+    return new BitwiseXor(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *BitwiseOr::clone(Substitution &subst) const
+{
+    return new BitwiseOr(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *LogicalAnd::clone(Substitution &subst) const
+{
+    return new LogicalAnd(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Expression *LogicalOr::clone(Substitution &subst) const
+{
+    return new LogicalOr(_left->clone(subst), _right->clone(subst), _type);
+}
+
+Statement *Assignment::clone(Substitution &subst) const
+{
+    return new Assignment(_left->clone(subst), _right->clone(subst));
+}
+
+Statement *Return::clone(Substitution &subst) const
+{
+    return new Return(_expr->clone(subst));
+}
+
+Statement *While::clone(Substitution &subst) const
+{
+    return new While(_expr->clone(subst), _stmt->clone(subst));
+}
+
+Statement *For::clone(Substitution &subst) const
+{
+    Statement *init = _init->clone(subst);
+    Expression *expr = _expr->clone(subst);
+    Statement *incr = _incr->clone(subst);
+
+    return new For(init, expr, incr, _stmt->clone(subst));
+}
+
+Statement *If::clone(Substitution &subst) const
+{
+    Expression *expr = _expr->clone(subst);
+    Statement *thenStmt = _thenStmt->clone(subst);
+    Statement *elseStmt = _elseStmt ? _elseStmt->clone(subst) : nullptr;
+
+    return new If(expr, thenStmt, elseStmt);
+}
+
+Statement *Switch::clone(Substitution &subst) const
+{
+    Expression *expr = _expr->clone(subst);
+    Statements stmts;
+
+    for (auto stmt : _stmts)
+	stmts.push_back(stmt->clone(subst));
+
+    return new Switch(expr, stmts, _cases, _default);
+}
+
+Statement *Break::clone(Substitution &subst) const
+{
+    return new Break();
+}
+
+Statement *Simple::clone(Substitution &subst) const
+{
+    return new Simple(_expr->clone(subst));
+}
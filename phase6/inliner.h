@@ -0,0 +1,15 @@
+/*
+ * File:	inliner.h
+ *
+ * Description:	This file contains the public function declarations for
+ *		inlining function calls in Simple C.
+ */
+
+# ifndef INLINER_H
+# define INLINER_H
+# include "Tree.h"
+
+void recordFunction(const Function *function);
+Expression *inlineCall(const Symbol *id, const Expressions &args, const Type &type);
+
+# endif /* INLINER_H */
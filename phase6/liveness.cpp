@@ -0,0 +1,556 @@
+/*
+ * File:	liveness.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		finding dead code in Simple C.
+ *
+ *		A variable is live at a point if its value may be read
+ *		before it is next assigned.  We compute the live variables
+ *		by walking each function backwards, iterating around loops
+ *		until nothing changes, and mark any assignment to a local
+ *		variable that is not live afterwards as dead.  Only local
+ *		variables whose addresses are never taken are considered,
+ *		since any other variable may be read indirectly or by
+ *		another function.
+ *
+ *		A statement returns if control never reaches its end, which
+ *		is true of a return or break statement, and of any statement
+ *		all of whose paths reach one.  A branch whose test is a constant
+ *		is only ever taken one way.  We also find whether a
+ *		statement assigns to a variable, so that a loop can tell
+ *		which variables are invariant.
+ */
+
+# include "Tree.h"
+# include "alias.h"
+
+using namespace std;
+
+static Variables exiting, breaking;
+static map<const Statement *, Variables> tops;
+
+
+/*
+ * Function:	Node::pure
+ *
+ * Description:	Return whether evaluating this node has no effect other
+ *		than computing its value.  By default, a node is pure.
+ */
+
+bool Node::pure() const
+{
+    return true;
+}
+
+
+/*
+ * The remaining functions simply check the children of each node, and
+ * aren't very interesting.  Note that an inlined call is treated as a
+ * call, since its body may assign to memory.
+ */
+
+bool Unary::pure() const
+{
+    return _expr->pure();
+}
+
+bool Binary::pure() const
+{
+    return _left->pure() && _right->pure();
+}
+
+bool Call::pure() const
+{
+    return false;
+}
+
+bool Inline::pure() const
+{
+    return false;
+}
+
+
+/*
+ * Function:	Statement::returns
+ *
+ * Description:	Return whether control never reaches the end of this
+ *		statement.  By default, it does.
+ */
+
+bool Statement::returns() const
+{
+    return false;
+}
+
+
+/*
+ * Function:	Return::returns
+ *
+ * Description:	Return whether control never reaches the end of this
+ *		return statement, which it never does.
+ */
+
+bool Return::returns() const
+{
+    return true;
+}
+
+
+/*
+ * Function:	Break::returns
+ *
+ * Description:	Return whether control never reaches the end of this
+ *		break statement, which it never does, since control leaves
+ *		the switch statement instead.
+ */
+
+bool Break::returns() const
+{
+    return true;
+}
+
+
+/*
+ * Function:	Block::returns
+ *
+ * Description:	Return whether control never reaches the end of this
+ *		block, which is true if any statement within it returns.
+ */
+
+bool Block::returns() const
+{
+    for (auto stmt : _stmts)
+	if (stmt->returns())
+	    return true;
+
+    return false;
+}
+
+
+/*
+ * Function:	While::returns
+ *
+ * Description:	Return whether control never reaches the end of this
+ *		while statement, which is true if its test is a nonzero
+ *		constant, since the loop can then only be left by a return.
+ */
+
+bool While::returns() const
+{
+    unsigned long value;
+
+    return _expr->isNumber(value) && value != 0;
+}
+
+
+/*
+ * Function:	For::returns
+ *
+ * Description:	Return whether control never reaches the end of this for
+ *		statement, which is true if its test is a nonzero constant.
+ */
+
+bool For::returns() const
+{
+    unsigned long value;
+
+    return _expr->isNumber(value) && value != 0;
+}
+
+
+/*
+ * Function:	If::returns
+ *
+ * Description:	Return whether control never reaches the end of this if
+ *		statement.  If the test is a constant, then only the branch
+ *		taken matters, and otherwise both branches must return.
+ */
+
+bool If::returns() const
+{
+    unsigned long value;
+
+
+    if (_expr->isNumber(value)) {
+	if (value != 0)
+	    return _thenStmt->returns();
+
+	return _elseStmt != nullptr && _elseStmt->returns();
+    }
+
+    if (_elseStmt == nullptr)
+	return false;
+
+    return _thenStmt->returns() && _elseStmt->returns();
+}
+
+
+/*
+ * Function:	Statement::assigns
+ *
+ * Description:	Return whether this statement may assign to the given
+ *		variable by name.  By default, it does not.
+ */
+
+bool Statement::assigns(const Symbol *symbol) const
+{
+    return false;
+}
+
+
+/*
+ * Function:	Assignment::assigns
+ *
+ * Description:	Return whether this assignment statement assigns to the
+ *		given variable, which is true if it is the left-hand side.
+ */
+
+bool Assignment::assigns(const Symbol *symbol) const
+{
+    const Symbol *left;
+
+    return _left->isIdentifier(left) && left == symbol;
+}
+
+
+/*
+ * The remaining assigns functions simply check the statements within each
+ * statement, and aren't very interesting.  An inlined call only assigns
+ * its own variables, so expressions need not be checked.
+ */
+
+bool Block::assigns(const Symbol *symbol) const
+{
+    for (auto stmt : _stmts)
+	if (stmt->assigns(symbol))
+	    return true;
+
+    return false;
+}
+
+bool While::assigns(const Symbol *symbol) const
+{
+    return _stmt->assigns(symbol);
+}
+
+bool For::assigns(const Symbol *symbol) const
+{
+    if (_init->assigns(symbol) || _incr->assigns(symbol))
+	return true;
+
+    return _stmt->assigns(symbol);
+}
+
+bool Switch::assigns(const Symbol *symbol) const
+{
+    for (auto stmt : _stmts)
+	if (stmt->assigns(symbol))
+	    return true;
+
+    return false;
+}
+
+bool If::assigns(const Symbol *symbol) const
+{
+    if (_thenStmt->assigns(symbol))
+	return true;
+
+    return _elseStmt != nullptr && _elseStmt->assigns(symbol);
+}
+
+
+/*
+ * Function:	Node::liveness
+ *
+ * Description:	Update the given set of variables live after this node to
+ *		those live before it.  By default, a node uses nothing.
+ */
+
+void Node::liveness(Variables &live)
+{
+}
+
+
+/*
+ * Function:	Identifier::liveness
+ *
+ * Description:	Update the live variables for an identifier, which uses
+ *		its own variable.
+ */
+
+void Identifier::liveness(Variables &live)
+{
+    live.insert(_symbol);
+}
+
+
+/*
+ * Function:	Inline::liveness
+ *
+ * Description:	Update the live variables for an inlined call.  A return
+ *		within the body leaves the body with the variables that are
+ *		live after the call.
+ */
+
+void Inline::liveness(Variables &live)
+{
+    Variables saved;
+
+
+    saved = exiting;
+    exiting = live;
+    _body->liveness(live);
+    exiting = saved;
+}
+
+
+/*
+ * Function:	Assignment::liveness
+ *
+ * Description:	Update the live variables for an assignment statement.
+ *		An assignment to a private variable kills it, and is dead
+ *		if the variable is not live afterwards.
+ */
+
+void Assignment::liveness(Variables &live)
+{
+    const Symbol *symbol;
+
+
+    if (_left->isIdentifier(symbol) && Location(_left).isPrivate()) {
+	_dead = live.count(symbol) == 0;
+	live.erase(symbol);
+    } else {
+	_dead = false;
+	_left->liveness(live);
+    }
+
+    _right->liveness(live);
+}
+
+
+/*
+ * Function:	Return::liveness
+ *
+ * Description:	Update the live variables for a return statement.  Any
+ *		variables live afterwards are irrelevant, since control
+ *		leaves the function (or the inlined call).
+ */
+
+void Return::liveness(Variables &live)
+{
+    live = exiting;
+    _expr->liveness(live);
+}
+
+
+/*
+ * Function:	While::liveness
+ *
+ * Description:	Update the live variables for a while statement.  The
+ *		variables live at the top of the loop are those live after
+ *		it plus those live before the test and body, which in turn
+ *		depend upon those live at the top, so we iterate until the
+ *		set no longer changes.  The set only grows each time an
+ *		enclosing loop walks this one, so we start from the set
+ *		found last time, and an inner loop need not iterate again
+ *		on every walk of the outer one.
+ */
+
+void While::liveness(Variables &live)
+{
+    Variables top, next;
+    unsigned long value;
+
+
+    if (_expr->isNumber(value) && value == 0)
+	return;
+
+    top = tops[this];
+    top.insert(live.begin(), live.end());
+
+    do {
+	next = top;
+	_stmt->liveness(next);
+	_expr->liveness(next);
+	next.insert(live.begin(), live.end());
+
+	if (next == top)
+	    break;
+
+	top = next;
+    } while (true);
+
+    tops[this] = top;
+    live = top;
+}
+
+
+/*
+ * Function:	For::liveness
+ *
+ * Description:	Update the live variables for a for statement, which is
+ *		just like a while statement with an initialization before
+ *		it and an increment at the end of the body.
+ */
+
+void For::liveness(Variables &live)
+{
+    Variables top, next;
+    unsigned long value;
+
+
+    if (!_expr->isNumber(value) || value != 0) {
+	top = tops[this];
+	top.insert(live.begin(), live.end());
+
+	do {
+	    next = top;
+	    _incr->liveness(next);
+	    _stmt->liveness(next);
+	    _expr->liveness(next);
+	    next.insert(live.begin(), live.end());
+
+	    if (next == top)
+		break;
+
+	    top = next;
+	} while (true);
+
+	tops[this] = top;
+	live = top;
+    }
+
+    _init->liveness(live);
+}
+
+
+/*
+ * Function:	If::liveness
+ *
+ * Description:	Update the live variables for an if statement, which are
+ *		those live before either branch and those used by the test.
+ *		If the test is a constant, only one branch is ever taken.
+ */
+
+void If::liveness(Variables &live)
+{
+    Variables other;
+    unsigned long value;
+
+
+    if (_expr->isNumber(value)) {
+	if (value != 0)
+	    _thenStmt->liveness(live);
+	else if (_elseStmt != nullptr)
+	    _elseStmt->liveness(live);
+
+	return;
+    }
+
+    other = live;
+    _thenStmt->liveness(live);
+
+    if (_elseStmt != nullptr)
+	_elseStmt->liveness(other);
+
+    live.insert(other.begin(), other.end());
+    _expr->liveness(live);
+}
+
+
+/*
+ * Function:	Switch::liveness
+ *
+ * Description:	Update the live variables for a switch statement.  We
+ *		walk the statements backwards, and the variables live at
+ *		each case label are also live before the switch.  A break
+ *		leaves the switch with the variables live after it, as does
+ *		a missing default.
+ */
+
+void Switch::liveness(Variables &live)
+{
+    Variables saved, entry;
+    unsigned i;
+
+
+    saved = breaking;
+    breaking = live;
+
+    if (labeled(_stmts.size()))
+	entry = live;
+
+    for (i = _stmts.size(); i > 0; i --) {
+	_stmts[i - 1]->liveness(live);
+
+	if (labeled(i - 1))
+	    entry.insert(live.begin(), live.end());
+    }
+
+    breaking = saved;
+    live = entry;
+    _expr->liveness(live);
+}
+
+
+/*
+ * Function:	Break::liveness
+ *
+ * Description:	Update the live variables for a break statement, which
+ *		are those live after the switch statement.
+ */
+
+void Break::liveness(Variables &live)
+{
+    live = breaking;
+}
+
+
+/*
+ * Function:	Function::liveness
+ *
+ * Description:	Find the live variables and dead assignments within this
+ *		function.  Nothing is live once the function returns.
+ */
+
+void Function::liveness(Variables &live)
+{
+    exiting.clear();
+    tops.clear();
+    _body->liveness(live);
+}
+
+
+/*
+ * The remaining functions simply visit the children of each node in
+ * reverse order of evaluation, and aren't very interesting.
+ */
+
+void Unary::liveness(Variables &live)
+{
+    _expr->liveness(live);
+}
+
+void Binary::liveness(Variables &live)
+{
+    _right->liveness(live);
+    _left->liveness(live);
+}
+
+void Call::liveness(Variables &live)
+{
+    for (unsigned i = _args.size(); i > 0; i --)
+	_args[i - 1]->liveness(live);
+}
+
+void Simple::liveness(Variables &live)
+{
+    _expr->liveness(live);
+}
+
+void Block::liveness(Variables &live)
+{
+    for (unsigned i = _stmts.size(); i > 0; i --)
+	_stmts[i - 1]->liveness(live);
+}
@@ -10,22 +10,31 @@
 # define SIZEOF_LONG 8
 # define SIZEOF_PTR  8
 # define SIZEOF_REG  8
+# define SIZEOF_VECTOR 16
+# define CACHE_LINE_SIZE 64
 
 # define SIZEOF_PARAM 8
 # define NUM_PARAM_REGS 6
 # define STACK_ALIGNMENT 16
+# define RED_ZONE_SIZE 128
 
 # if defined (__linux__) && defined(__x86_64__)
 
 # define global_prefix ""
 # define global_suffix ""
 # define label_prefix ".L"
+# define const_section "\t.section\t.rodata"
+# define string_section "\t.section\t.rodata.str1.1,\"aMS\",@progbits,1"
+# define comm_log2 false
 
 # elif defined (__APPLE__) && defined(__x86_64__)
 
 # define global_prefix "_"
 # define global_suffix "(%rip)"
 # define label_prefix "L"
+# define const_section "\t.const"
+# define string_section "\t.cstring"
+# define comm_log2 true
 
 # else
 
@@ -0,0 +1,144 @@
+/*
+ * File:	options.cpp
+ *
+ * Description:	This file contains the definitions and parsing of the
+ *		command-line options that control optimization in the
+ *		compiler for Simple C.  Each option is of the form
+ *		-fname=value, or -fname and -fno-name for a flag.
+ */
+
+# include <climits>
+# include <cstdlib>
+# include <cstring>
+# include <iostream>
+# include "options.h"
+
+using namespace std;
+
+unsigned inline_limit = 30;
+unsigned inline_budget = 300;
+unsigned unroll_limit = 128;
+unsigned unroll_factor = 0;
+unsigned unswitch_limit = 200;
+unsigned thread_limit = 30;
+unsigned cmov_limit = 8;
+unsigned table_limit = 4096;
+unsigned array_alignment = 16;
+bool peephole = true;
+bool peephole_stats = false;
+bool cse = true;
+bool dce = true;
+bool sccp = true;
+bool jump_tables = true;
+bool vrp = true;
+
+
+/*
+ * Function:	usage (private)
+ *
+ * Description:	Report an invalid option to standard error and exit.
+ */
+
+static void usage(const char *arg)
+{
+    cerr << "scc: unrecognized option '" << arg << "'" << endl;
+    cerr << "usage: scc [-fno-inline] [-finline-limit=n] [-finline-budget=n]";
+    cerr << " [-fno-peephole] [-fpeephole-stats] [-fno-cse] [-fno-dce]";
+    cerr << " [-fno-sccp] [-fno-unroll] [-funroll-limit=n]";
+    cerr << " [-funroll-factor=n] [-fno-unswitch] [-funswitch-limit=n]";
+    cerr << " [-fno-thread] [-fthread-limit=n] [-fcmov] [-fno-cmov]";
+    cerr << " [-fcmov-limit=n] [-fno-jump-tables] [-fjump-table-limit=n]";
+    cerr << " [-fno-vrp] [-falign-arrays=n]";
+    cerr << " < input.c > output.s" << endl;
+    exit(EXIT_FAILURE);
+}
+
+
+/*
+ * Function:	value (private)
+ *
+ * Description:	If the given argument is an option with the given name,
+ *		store its numeric value and return true.
+ */
+
+static bool value(const char *arg, const char *name, unsigned &result)
+{
+    size_t length = strlen(name);
+    char *end;
+
+
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=')
+	return false;
+
+    result = strtoul(arg + length + 1, &end, 0);
+
+    if (arg[length + 1] == 0 || *end != 0)
+	usage(arg);
+
+    return true;
+}
+
+
+/*
+ * Function:	parseOptions
+ *
+ * Description:	Parse the command-line arguments.  Any argument that is
+ *		not a recognized option is an error, since our input is
+ *		always read from the standard input.
+ */
+
+void parseOptions(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i ++) {
+	const char *arg = argv[i];
+
+	if (strcmp(arg, "-fno-inline") == 0)
+	    inline_limit = 0;
+	else if (value(arg, "-finline-limit", inline_limit))
+	    continue;
+	else if (value(arg, "-finline-budget", inline_budget))
+	    continue;
+	else if (strcmp(arg, "-fno-peephole") == 0)
+	    peephole = false;
+	else if (strcmp(arg, "-fpeephole-stats") == 0)
+	    peephole_stats = true;
+	else if (strcmp(arg, "-fno-cse") == 0)
+	    cse = false;
+	else if (strcmp(arg, "-fno-dce") == 0)
+	    dce = false;
+	else if (strcmp(arg, "-fno-sccp") == 0)
+	    sccp = false;
+	else if (strcmp(arg, "-fno-unroll") == 0)
+	    unroll_limit = 0;
+	else if (value(arg, "-funroll-limit", unroll_limit))
+	    continue;
+	else if (value(arg, "-funroll-factor", unroll_factor))
+	    continue;
+	else if (strcmp(arg, "-fno-unswitch") == 0)
+	    unswitch_limit = 0;
+	else if (value(arg, "-funswitch-limit", unswitch_limit))
+	    continue;
+	else if (strcmp(arg, "-fno-thread") == 0)
+	    thread_limit = 0;
+	else if (value(arg, "-fthread-limit", thread_limit))
+	    continue;
+	else if (strcmp(arg, "-fcmov") == 0)
+	    cmov_limit = UINT_MAX;
+	else if (strcmp(arg, "-fno-cmov") == 0)
+	    cmov_limit = 0;
+	else if (value(arg, "-fcmov-limit", cmov_limit))
+	    continue;
+	else if (strcmp(arg, "-fno-jump-tables") == 0)
+	    jump_tables = false;
+	else if (value(arg, "-fjump-table-limit", table_limit))
+	    continue;
+	else if (strcmp(arg, "-fno-vrp") == 0)
+	    vrp = false;
+	else if (value(arg, "-falign-arrays", array_alignment)) {
+	    if (array_alignment == 0 || (array_alignment & (array_alignment - 1)))
+		usage(arg);
+	}
+	else
+	    usage(arg);
+    }
+}
@@ -0,0 +1,19 @@
+/*
+ * File:	options.h
+ *
+ * Description:	This file contains the declarations of the command-line
+ *		options that control optimization in the compiler for
+ *		Simple C.
+ */
+
+# ifndef OPTIONS_H
+# define OPTIONS_H
+
+extern unsigned inline_limit, inline_budget, unroll_limit, unroll_factor;
+extern unsigned unswitch_limit, thread_limit, cmov_limit, table_limit;
+extern unsigned array_alignment;
+extern bool peephole, peephole_stats, cse, dce, sccp, jump_tables, vrp;
+
+void parseOptions(int argc, char *argv[]);
+
+# endif /* OPTIONS_H */
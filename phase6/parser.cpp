@@ -10,6 +10,9 @@
 # include <iostream>
 # include "generator.h"
 # include "checker.h"
+# include "inliner.h"
+# include "options.h"
+# include "peephole.h"
 # include "string.h"
 # include "tokens.h"
 # include "lexer.h"
@@ -22,6 +25,8 @@ static string lexbuf;
 static Expression *expression();
 static Statement *statement();
 static Type returnType;
+static bool breakable;
+static Expression *operand;
 
 
 /*
@@ -101,7 +106,8 @@ static string identifier()
 
 static bool isSpecifier(int token)
 {
-    return token == INT || token == CHAR || token == LONG || token == VOID;
+    return token == INT || token == CHAR || token == LONG || token == VOID ||
+	token == UNSIGNED;
 }
 
 
@@ -109,20 +115,38 @@ static bool isSpecifier(int token)
  * Function:	specifier
  *
  * Description:	Parse a type specifier.  Simple C has only ints, chars,
- *		longs,and void types.
+ *		longs, their unsigned counterparts, and void types.  An
+ *		unsigned type written alone is an unsigned int.
  *
  *		specifier:
  *		  int
  *		  char
  *		  long
  *		  void
+ *		  unsigned
+ *		  unsigned int
+ *		  unsigned char
+ *		  unsigned long
  */
 
 static int specifier()
 {
     int typespec = lookahead;
 
-    if (isSpecifier(lookahead))
+    if (lookahead == UNSIGNED) {
+	match(UNSIGNED);
+	typespec = UNSIGNED_INT;
+
+	if (lookahead == CHAR)
+	    typespec = UNSIGNED_CHAR;
+	else if (lookahead == LONG)
+	    typespec = UNSIGNED_LONG;
+	else if (lookahead != INT)
+	    return typespec;
+
+	match(lookahead);
+
+    } else if (isSpecifier(lookahead))
 	match(lookahead);
     else
 	error();
@@ -332,6 +356,7 @@ static Expression *postfixExpression()
 	left = checkArray(left, right);
     }
 
+    operand = left;
     return left;
 }
 
@@ -345,6 +370,7 @@ static Expression *postfixExpression()
  *		  postfix-expression
  *		  ! prefix-expression
  *		  - prefix-expression
+ *		  ~ prefix-expression
  *		  * prefix-expression
  *		  & prefix-expression
  *		  sizeof prefix-expression
@@ -365,6 +391,11 @@ static Expression *prefixExpression()
 	expr = prefixExpression();
 	expr = checkNegate(expr);
 
+    } else if (lookahead == '~') {
+	match('~');
+	expr = prefixExpression();
+	expr = checkComplement(expr);
+
     } else if (lookahead == '*') {
 	match('*');
 	expr = prefixExpression();
@@ -469,19 +500,54 @@ static Expression *additiveExpression()
 }
 
 
+/*
+ * Function:	shiftExpression
+ *
+ * Description:	Parse a shift expression.
+ *
+ *		shift-expression:
+ *		  additive-expression
+ *		  shift-expression << additive-expression
+ *		  shift-expression >> additive-expression
+ */
+
+static Expression *shiftExpression()
+{
+    Expression *left, *right;
+
+
+    left = additiveExpression();
+
+    while (1) {
+	if (lookahead == SHL) {
+	    match(SHL);
+	    right = additiveExpression();
+	    left = checkLeftShift(left, right);
+
+	} else if (lookahead == SHR) {
+	    match(SHR);
+	    right = additiveExpression();
+	    left = checkRightShift(left, right);
+
+	} else
+	    break;
+    }
+
+    return left;
+}
+
+
 /*
  * Function:	relationalExpression
  *
- * Description:	Parse a relational expression.  Note that Simple C does not
- *		have shift operators, so we go immediately to additive
- *		expressions.
+ * Description:	Parse a relational expression.
  *
  *		relational-expression:
- *		  additive-expression
- *		  relational-expression < additive-expression
- *		  relational-expression > additive-expression
- *		  relational-expression <= additive-expression
- *		  relational-expression >= additive-expression
+ *		  shift-expression
+ *		  relational-expression < shift-expression
+ *		  relational-expression > shift-expression
+ *		  relational-expression <= shift-expression
+ *		  relational-expression >= shift-expression
  */
 
 static Expression *relationalExpression()
@@ -489,27 +555,27 @@ static Expression *relationalExpression()
     Expression *left, *right;
 
 
-    left = additiveExpression();
+    left = shiftExpression();
 
     while (1) {
 	if (lookahead == '<') {
 	    match('<');
-	    right = additiveExpression();
+	    right = shiftExpression();
 	    left = checkLessThan(left, right);
 
 	} else if (lookahead == '>') {
 	    match('>');
-	    right = additiveExpression();
+	    right = shiftExpression();
 	    left = checkGreaterThan(left, right);
 
 	} else if (lookahead == LEQ) {
 	    match(LEQ);
-	    right = additiveExpression();
+	    right = shiftExpression();
 	    left = checkLessOrEqual(left, right);
 
 	} else if (lookahead == GEQ) {
 	    match(GEQ);
-	    right = additiveExpression();
+	    right = shiftExpression();
 	    left = checkGreaterOrEqual(left, right);
 
 	} else
@@ -557,15 +623,95 @@ static Expression *equalityExpression()
 }
 
 
+/*
+ * Function:	bitwiseAndExpression
+ *
+ * Description:	Parse a bitwise-and expression.
+ *
+ *		bitwise-and-expression:
+ *		  equality-expression
+ *		  bitwise-and-expression & equality-expression
+ */
+
+static Expression *bitwiseAndExpression()
+{
+    Expression *left, *right;
+
+
+    left = equalityExpression();
+
+    while (lookahead == '&') {
+	match('&');
+	right = equalityExpression();
+	left = checkBitwiseAnd(left, right);
+    }
+
+    return left;
+}
+
+
+/*
+ * Function:	bitwiseXorExpression
+ *
+ * Description:	Parse a bitwise exclusive-or expression.
+ *
+ *		bitwise-xor-expression:
+ *		  bitwise-and-expression
+ *		  bitwise-xor-expression ^ bitwise-and-expression
+ */
+
+static Expression *bitwiseXorExpression()
+{
+    Expression *left, *right;
+
+
+    left = bitwiseAndExpression();
+
+    while (lookahead == '^') {
+	match('^');
+	right = bitwiseAndExpression();
+	left = checkBitwiseXor(left, right);
+    }
+
+    return left;
+}
+
+
+/*
+ * Function:	bitwiseOrExpression
+ *
+ * Description:	Parse a bitwise-or expression.
+ *
+ *		bitwise-or-expression:
+ *		  bitwise-xor-expression
+ *		  bitwise-or-expression | bitwise-xor-expression
+ */
+
+static Expression *bitwiseOrExpression()
+{
+    Expression *left, *right;
+
+
+    left = bitwiseXorExpression();
+
+    while (lookahead == '|') {
+	match('|');
+	right = bitwiseXorExpression();
+	left = checkBitwiseOr(left, right);
+    }
+
+    return left;
+}
+
+
 /*
  * Function:	logicalAndExpression
  *
- * Description:	Parse a logical-and expression.  Note that Simple C does
- *		not have bitwise-and expressions.
+ * Description:	Parse a logical-and expression.
  *
  *		logical-and-expression:
- *		  equality-expression
- *		  logical-and-expression && equality-expression
+ *		  bitwise-or-expression
+ *		  logical-and-expression && bitwise-or-expression
  */
 
 static Expression *logicalAndExpression()
@@ -573,11 +719,11 @@ static Expression *logicalAndExpression()
     Expression *left, *right;
 
 
-    left = equalityExpression();
+    left = bitwiseOrExpression();
 
     while (lookahead == AND) {
 	match(AND);
-	right = equalityExpression();
+	right = bitwiseOrExpression();
 	left = checkLogicalAnd(left, right);
     }
 
@@ -639,21 +785,71 @@ static Statements statements()
 }
 
 
+/*
+ * Function:	encloses (private)
+ *
+ * Description:	Return whether the given expression is the last postfix
+ *		expression parsed, or is formed from it by unary operators
+ *		that only read its value.  The operand of sizeof is never
+ *		evaluated, and an address is not an lvalue, so neither may
+ *		enclose an increment or decrement.
+ */
+
+static bool encloses(Expression *expr)
+{
+    Unary *unary;
+
+
+    while (expr != operand) {
+	unary = dynamic_cast<Unary *>(expr);
+
+	if (unary == nullptr || dynamic_cast<Address *>(expr) != nullptr)
+	    return false;
+
+	expr = unary->expr();
+    }
+
+    return true;
+}
+
+
 /*
  * Function:	Assignment
  *
- * Description:	Parse an assignment statement.
+ * Description:	Parse an assignment statement.  Since Simple C does not
+ *		allow assignment as an expression operator, an increment
+ *		or decrement is also a statement rather than an expression.
+ *		A postfix increment applies to the last postfix expression
+ *		parsed, so *p++ increments p.  The enclosing expression may
+ *		only apply unary operators that read the operand, and since
+ *		its value is discarded, only the increment is done, which
+ *		evaluates the operand just once.
  *
  *		assignment:
  *		  expression = expression
+ *		  expression assignment-operator expression
+ *		  expression ++
+ *		  expression --
+ *		  ++ prefix-expression
+ *		  -- prefix-expression
  *		  expression
+ *
+ *		assignment-operator: one of
+ *		  += -= *= /= %= &= |= ^= <<= >>=
  */
 
 static Statement *assignment()
 {
     Expression *expr;
+    int op;
 
 
+    if (lookahead == INC || lookahead == DEC) {
+	op = lookahead;
+	match(op);
+	return checkCompound(prefixExpression(), op, nullptr);
+    }
+
     expr = expression();
 
     if (lookahead == '=') {
@@ -661,6 +857,21 @@ static Statement *assignment()
 	return checkAssignment(expr, expression());
     }
 
+    if (lookahead == INC || lookahead == DEC) {
+	if (!encloses(expr))
+	    error();
+
+	op = lookahead;
+	match(op);
+	return checkCompound(operand, op, nullptr);
+    }
+
+    if (lookahead >= ADD_ASSIGN && lookahead <= SHR_ASSIGN) {
+	op = lookahead;
+	match(op);
+	return checkCompound(expr, op, expression());
+    }
+
     return new Simple(expr);
 }
 
@@ -678,7 +889,18 @@ static Statement *assignment()
  *		  for ( assignment ; expression ; assignment ) statement
  *		  if ( expression ) statement
  *		  if ( expression ) statement else statement
+ *		  switch ( expression ) { cases }
+ *		  break ;
  *		  assignment ;
+ *
+ *		cases:
+ *		  empty
+ *		  case expression : cases
+ *		  default : cases
+ *		  statement cases
+ *
+ *		A break statement may only appear within a switch, and not
+ *		within a loop within the switch.
  */
 
 static Statement *statement()
@@ -687,6 +909,9 @@ static Statement *statement()
     Expression *expr;
     Statement *stmt, *init, *incr;
     Statements stmts;
+    Cases cases;
+    unsigned dflt;
+    bool saved, seen;
 
 
     if (lookahead == '{') {
@@ -711,7 +936,10 @@ static Statement *statement()
 	expr = expression();
 	checkTest(expr);
 	match(')');
+	saved = breakable;
+	breakable = false;
 	stmt = statement();
+	breakable = saved;
 	stmt = new While(expr, stmt);
 
     } else if (lookahead == FOR) {
@@ -724,7 +952,10 @@ static Statement *statement()
 	match(';');
 	incr = assignment();
 	match(')');
+	saved = breakable;
+	breakable = false;
 	stmt = statement();
+	breakable = saved;
 	stmt = new For(init, expr, incr, stmt);
 
     } else if (lookahead == IF) {
@@ -741,6 +972,41 @@ static Statement *statement()
 	} else
 	    stmt = new If(expr, stmt, nullptr);
 
+    } else if (lookahead == SWITCH) {
+	match(SWITCH);
+	match('(');
+	expr = expression();
+	checkSwitch(expr);
+	match(')');
+	match('{');
+	saved = breakable;
+	breakable = true;
+	seen = false;
+	dflt = 0;
+
+	while (lookahead != '}')
+	    if (lookahead == CASE) {
+		match(CASE);
+		checkCase(expression(), expr->type(), cases, stmts.size());
+		match(':');
+	    } else if (lookahead == DEFAULT) {
+		match(DEFAULT);
+		match(':');
+		checkDefault(seen, dflt, stmts.size());
+		seen = true;
+	    } else
+		stmts.push_back(statement());
+
+	match('}');
+	breakable = saved;
+	stmt = new Switch(expr, stmts, cases, seen ? dflt : stmts.size());
+
+    } else if (lookahead == BREAK) {
+	match(BREAK);
+	checkBreak(breakable);
+	match(';');
+	stmt = new Break();
+
     } else {
 	stmt = assignment();
 	match(';');
@@ -943,8 +1209,10 @@ static void globalOrFunction()
 	    function = new Function(id, new Block(decls, stmts));
 	    match('}');
 
-	    if (numerrors == 0)
+	    if (numerrors == 0) {
 		function->generate();
+		recordFunction(function);
+	    }
 	}
 
     } else {
@@ -957,11 +1225,13 @@ static void globalOrFunction()
 /*
  * Function:	main
  *
- * Description:	Analyze the standard input stream.
+ * Description:	Analyze the standard input stream.  Any command-line
+ *		arguments are options controlling optimization.
  */
 
-int main()
+int main(int argc, char *argv[])
 {
+    parseOptions(argc, argv);
     openScope();
     lookahead = yylex();
     lexbuf = yytext;
@@ -970,5 +1240,9 @@ int main()
 	globalOrFunction();
 
     generateGlobals(closeScope());
+
+    if (peephole_stats)
+	writePeepholeStats(cerr);
+
     exit(EXIT_SUCCESS);
 }
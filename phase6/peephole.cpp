@@ -0,0 +1,554 @@
+/*
+ * File:	peephole.cpp
+ *
+ * Description:	This file contains the public and private function and
+ *		variable definitions for the peephole optimizer for Simple
+ *		C.
+ *
+ *		The code generated for a function is first parsed into a
+ *		list of instructions, each of which is a label, a comment,
+ *		or an opcode with its operands.  The rules are then applied
+ *		to each window of consecutive instructions until no rule
+ *		applies.  Comments and blank lines are skipped when forming
+ *		a window, but a label is not, so no window extends across
+ *		a branch target unless a rule explicitly allows it.  Each
+ *		pass is a single forward sweep that copies the instructions
+ *		to a new list, marking those matched by a rule as deleted
+ *		so that they are not copied when the sweep reaches them.
+ *
+ *		Each rule is a pattern of instructions and its replacement,
+ *		written in assembly syntax.  Within a rule, {x} is a
+ *		variable that matches any text, consistently throughout the
+ *		rule.  A variable whose name begins with r only matches a
+ *		register, and one whose name begins with m only matches a
+ *		memory reference.  In a replacement, {~x} is the inverse of
+ *		the condition code bound to x.  A rule may also have a
+ *		condition that must hold for the rule to apply.
+ */
+
+# include <map>
+# include <vector>
+# include <sstream>
+# include "peephole.h"
+
+using namespace std;
+
+typedef map<string, string> Bindings;
+
+struct Instruction {
+    string label;
+    string opcode;
+    vector<string> operands;
+    string text;
+    bool deleted;
+};
+
+typedef vector<Instruction> Instructions;
+
+struct Rule {
+    const char *name;
+    vector<string> pattern;
+    vector<string> replacement;
+    bool (*condition)(const Bindings &vars, const Instructions &insns, unsigned next);
+    unsigned hits;
+    Instructions parsed;
+};
+
+static bool flagsDead(const Bindings &vars, const Instructions &insns, unsigned next);
+static bool independent(const Bindings &vars, const Instructions &insns, unsigned next);
+
+static Rule rules[] = {
+    {"redundant-load",
+	{"mov{s}\t{r}, {m}", "mov{s}\t{m}, {r}"},
+	{"mov{s}\t{r}, {m}"}, nullptr, 0},
+
+    {"redundant-store",
+	{"mov{s}\t{m}, {r}", "mov{s}\t{r}, {m}"},
+	{"mov{s}\t{m}, {r}"}, independent, 0},
+
+    {"self-move",
+	{"movq\t{r}, {r}"},
+	{}, nullptr, 0},
+
+    {"compare-zero",
+	{"cmp{s}\t$0, {r}"},
+	{"test{s}\t{r}, {r}"}, nullptr, 0},
+
+    {"zero-register",
+	{"mov{s}\t$0, {r}"},
+	{"xor{s}\t{r}, {r}"}, flagsDead, 0},
+
+    {"retest-true",
+	{"set{c}\t{r}", "movzbl\t{r}, {x}", "testl\t{x}, {x}", "jne\t{l}"},
+	{"set{c}\t{r}", "movzbl\t{r}, {x}", "j{c}\t{l}"}, nullptr, 0},
+
+    {"retest-false",
+	{"set{c}\t{r}", "movzbl\t{r}, {x}", "testl\t{x}, {x}", "je\t{l}"},
+	{"set{c}\t{r}", "movzbl\t{r}, {x}", "j{~c}\t{l}"}, nullptr, 0},
+
+    {"jump-over-jump",
+	{"j{c}\t{l}", "jmp\t{x}", "{l}:"},
+	{"j{~c}\t{x}", "{l}:"}, nullptr, 0},
+
+    {"jump-to-next",
+	{"jmp\t{l}", "{l}:"},
+	{"{l}:"}, nullptr, 0},
+};
+
+static map<string, string> inverses = {
+    {"e", "ne"}, {"ne", "e"}, {"z", "nz"}, {"nz", "z"},
+    {"l", "ge"}, {"ge", "l"}, {"g", "le"}, {"le", "g"},
+    {"b", "ae"}, {"ae", "b"}, {"a", "be"}, {"be", "a"},
+    {"s", "ns"}, {"ns", "s"},
+};
+
+
+/*
+ * Function:	parse (private)
+ *
+ * Description:	Parse a single line of assembly into an instruction.
+ */
+
+static Instruction parse(const string &line)
+{
+    Instruction insn;
+    size_t start, end;
+    int depth;
+
+
+    insn.deleted = false;
+
+    if (line.empty() || line[0] == '#' || line[0] == ' ') {
+	insn.text = line;
+	return insn;
+    }
+
+    if (line[0] != '\t') {
+	if (line[line.size() - 1] == ':')
+	    insn.label = line.substr(0, line.size() - 1);
+	else
+	    insn.text = line;
+
+	return insn;
+    }
+
+    end = line.find('\t', 1);
+    insn.opcode = line.substr(1, end == string::npos ? end : end - 1);
+
+    if (insn.opcode[0] == '.' || insn.opcode[0] == '#') {
+	insn.opcode = "";
+	insn.text = line;
+	return insn;
+    }
+
+    if (end == string::npos)
+	return insn;
+
+
+    /* Split the operands at any commas not within parentheses. */
+
+    start = end + 1;
+    depth = 0;
+
+    for (end = start; end <= line.size(); end ++)
+	if (end == line.size() || (line[end] == ',' && depth == 0)) {
+	    while (start < end && line[start] == ' ')
+		start ++;
+
+	    insn.operands.push_back(line.substr(start, end - start));
+	    start = end + 1;
+
+	} else if (line[end] == '(')
+	    depth ++;
+	else if (line[end] == ')')
+	    depth --;
+
+    return insn;
+}
+
+
+/*
+ * Function:	parseRule (private)
+ *
+ * Description:	Parse a single line of a rule, which is written without
+ *		the leading tab of an instruction.
+ */
+
+static Instruction parseRule(const string &line)
+{
+    if (line[line.size() - 1] == ':')
+	return parse(line);
+
+    return parse("\t" + line);
+}
+
+
+/*
+ * Function:	operator << (private)
+ *
+ * Description:	Write an instruction to the specified stream.
+ */
+
+static ostream &operator <<(ostream &ostr, const Instruction &insn)
+{
+    if (!insn.label.empty())
+	return ostr << insn.label << ":";
+
+    if (insn.opcode.empty())
+	return ostr << insn.text;
+
+    ostr << "\t" << insn.opcode;
+
+    for (unsigned i = 0; i < insn.operands.size(); i ++)
+	ostr << (i == 0 ? "\t" : ", ") << insn.operands[i];
+
+    return ostr;
+}
+
+
+/*
+ * Function:	skipped (private)
+ *
+ * Description:	Return whether an instruction is skipped when forming a
+ *		window, which is the case for comments, blank lines, and
+ *		instructions already deleted by a rule.
+ */
+
+static bool skipped(const Instruction &insn)
+{
+    return insn.deleted || (insn.label.empty() && insn.opcode.empty());
+}
+
+
+/*
+ * Function:	valid (private)
+ *
+ * Description:	Return whether the given text may be bound to a variable
+ *		with the given name.
+ */
+
+static bool valid(const string &name, const string &text)
+{
+    if (name[0] == 'r')
+	return text[0] == '%' && text.find('(') == string::npos;
+
+    if (name[0] == 'm')
+	return text[0] != '%' && text[0] != '$';
+
+    return true;
+}
+
+
+/*
+ * Function:	match (private)
+ *
+ * Description:	Match the text against the pattern starting at the given
+ *		positions, binding any variables in the pattern.
+ */
+
+static bool match(const string &pattern, size_t p, const string &text, size_t t, Bindings &vars)
+{
+    size_t end;
+    string name;
+
+
+    if (p == pattern.size())
+	return t == text.size();
+
+    if (pattern[p] != '{')
+	return t < text.size() && pattern[p] == text[t] && match(pattern, p + 1, text, t + 1, vars);
+
+    end = pattern.find('}', p);
+    name = pattern.substr(p + 1, end - p - 1);
+
+    if (vars.count(name) > 0) {
+	const string value = vars[name];
+
+	if (text.compare(t, value.size(), value) != 0)
+	    return false;
+
+	return match(pattern, end + 1, text, t + value.size(), vars);
+    }
+
+    for (size_t n = 1; t + n <= text.size(); n ++) {
+	vars[name] = text.substr(t, n);
+
+	if (valid(name, vars[name]) && match(pattern, end + 1, text, t + n, vars))
+	    return true;
+    }
+
+    vars.erase(name);
+    return false;
+}
+
+
+/*
+ * Function:	match (private)
+ *
+ * Description:	Match an instruction against an instruction of a pattern.
+ */
+
+static bool match(const Instruction &pattern, const Instruction &insn, Bindings &vars)
+{
+    Bindings saved = vars;
+
+
+    if (pattern.label.empty() != insn.label.empty())
+	return false;
+
+    if (!pattern.label.empty())
+	return match(pattern.label, 0, insn.label, 0, vars);
+
+    if (pattern.operands.size() != insn.operands.size())
+	return false;
+
+    if (match(pattern.opcode, 0, insn.opcode, 0, vars)) {
+	for (unsigned i = 0; i < insn.operands.size(); i ++)
+	    if (!match(pattern.operands[i], 0, insn.operands[i], 0, vars)) {
+		vars = saved;
+		return false;
+	    }
+
+	return true;
+    }
+
+    vars = saved;
+    return false;
+}
+
+
+/*
+ * Function:	substitute (private)
+ *
+ * Description:	Substitute the values of any variables in the given line
+ *		of a replacement, and return false if a condition code
+ *		cannot be inverted.
+ */
+
+static bool substitute(const string &line, Bindings &vars, string &result)
+{
+    size_t start, end;
+    string name;
+
+
+    result = "";
+
+    for (start = 0; (end = line.find('{', start)) != string::npos; start = end + 1) {
+	result += line.substr(start, end - start);
+	start = end + 1;
+	end = line.find('}', start);
+	name = line.substr(start, end - start);
+
+	if (name[0] != '~')
+	    result += vars[name];
+	else if (inverses.count(vars[name.substr(1)]) > 0)
+	    result += inverses[vars[name.substr(1)]];
+	else
+	    return false;
+    }
+
+    result += line.substr(start);
+    return true;
+}
+
+
+/*
+ * Function:	apply (private)
+ *
+ * Description:	Attempt to apply a rule to the window of instructions
+ *		starting at the given index.  If the rule applies, the
+ *		matched instructions are marked as deleted and the
+ *		replacement is appended to the output list.
+ */
+
+static bool apply(Rule &rule, Instructions &insns, unsigned first, Instructions &output)
+{
+    vector<unsigned> indices;
+    Instructions replacement;
+    Bindings vars;
+    unsigned next;
+    string line;
+
+
+    if (skipped(insns[first]))
+	return false;
+
+    next = first;
+
+    for (auto &pattern : rule.parsed) {
+	while (next < insns.size() && skipped(insns[next]))
+	    next ++;
+
+	if (next == insns.size() || !match(pattern, insns[next], vars))
+	    return false;
+
+	indices.push_back(next ++);
+    }
+
+    if (rule.condition != nullptr && !rule.condition(vars, insns, next))
+	return false;
+
+    for (auto &text : rule.replacement) {
+	if (!substitute(text, vars, line))
+	    return false;
+
+	replacement.push_back(parseRule(line));
+    }
+
+    for (auto index : indices)
+	insns[index].deleted = true;
+
+    output.insert(output.end(), replacement.begin(), replacement.end());
+    rule.hits ++;
+    return true;
+}
+
+
+/*
+ * Function:	flagsDead (private)
+ *
+ * Description:	Return whether the condition flags are dead at the given
+ *		instruction, which is the case if they are written before
+ *		they are read.  We conservatively assume that they are
+ *		live at any label or branch.
+ */
+
+static bool flagsDead(const Bindings &vars, const Instructions &insns, unsigned next)
+{
+    static const vector<string> readers = {"set", "cmov", "adc", "sbb"};
+    static const vector<string> writers = {
+	"cmp", "test", "add", "sub", "and", "or", "xor", "imul", "neg",
+	"sal", "sar", "shl", "shr", "idiv", "div", "inc", "dec", "call", "ret",
+    };
+
+    for (unsigned i = next; i < insns.size(); i ++) {
+	const string &opcode = insns[i].opcode;
+
+	if (insns[i].deleted)
+	    continue;
+
+	if (!insns[i].label.empty() || opcode[0] == 'j')
+	    return false;
+
+	for (auto &prefix : readers)
+	    if (opcode.compare(0, prefix.size(), prefix) == 0)
+		return false;
+
+	for (auto &prefix : writers)
+	    if (opcode.compare(0, prefix.size(), prefix) == 0)
+		return true;
+    }
+
+    return false;
+}
+
+
+/*
+ * Function:	independent (private)
+ *
+ * Description:	Return whether the memory reference bound to m does not
+ *		depend upon the register bound to r, since otherwise the
+ *		memory reference changes when the register is loaded.
+ */
+
+static bool independent(const Bindings &vars, const Instructions &insns, unsigned next)
+{
+    static const vector<string> families = {
+	"%rax %eax %ax %al", "%rbx %ebx %bx %bl", "%rcx %ecx %cx %cl",
+	"%rdx %edx %dx %dl", "%rsi %esi %si %sil", "%rdi %edi %di %dil",
+	"%r8 %r8d %r8w %r8b", "%r9 %r9d %r9w %r9b", "%r10 %r10d %r10w %r10b",
+	"%r11 %r11d %r11w %r11b", "%r12 %r12d %r12w %r12b",
+	"%r13 %r13d %r13w %r13b", "%r14 %r14d %r14w %r14b",
+	"%r15 %r15d %r15w %r15b",
+    };
+
+    const string &reg = vars.at("r"), &mem = vars.at("m");
+    string name;
+
+
+    for (auto &family : families) {
+	istringstream names(family);
+
+	while (names >> name)
+	    if (name == reg) {
+		names.clear();
+		names.str(family);
+		names >> name;
+
+		for (size_t pos = mem.find(name); pos != string::npos; pos = mem.find(name, pos + 1))
+		    if (mem[pos + name.size()] == ',' || mem[pos + name.size()] == ')')
+			return false;
+
+		return true;
+	    }
+    }
+
+    return false;
+}
+
+
+/*
+ * Function:	optimizeInstructions
+ *
+ * Description:	Apply the peephole rules to the given assembly code until
+ *		no rule applies, and return the resulting code.  The rule
+ *		patterns are parsed only once.
+ */
+
+string optimizeInstructions(const string &text)
+{
+    Instructions insns, result;
+    istringstream input(text);
+    ostringstream output;
+    bool changed, applied;
+    string line;
+
+
+    for (auto &rule : rules)
+	if (rule.parsed.size() != rule.pattern.size())
+	    for (auto &pattern : rule.pattern)
+		rule.parsed.push_back(parseRule(pattern));
+
+    while (getline(input, line))
+	insns.push_back(parse(line));
+
+    do {
+	changed = false;
+	result.clear();
+
+	for (unsigned i = 0; i < insns.size(); i ++) {
+	    applied = false;
+
+	    for (auto &rule : rules)
+		if (!applied && apply(rule, insns, i, result))
+		    applied = true;
+
+	    if (applied)
+		changed = true;
+	    else if (!insns[i].deleted)
+		result.push_back(insns[i]);
+	}
+
+	insns.swap(result);
+
+    } while (changed);
+
+    for (auto &insn : insns)
+	output << insn << endl;
+
+    return output.str();
+}
+
+
+/*
+ * Function:	writePeepholeStats
+ *
+ * Description:	Write the number of times each rule was applied to the
+ *		specified stream.
+ */
+
+void writePeepholeStats(ostream &ostr)
+{
+    for (auto &rule : rules)
+	ostr << "peephole: " << rule.name << ": " << rule.hits << endl;
+}
@@ -0,0 +1,16 @@
+/*
+ * File:	peephole.h
+ *
+ * Description:	This file contains the public function declarations for
+ *		the peephole optimizer for Simple C.
+ */
+
+# ifndef PEEPHOLE_H
+# define PEEPHOLE_H
+# include <string>
+# include <ostream>
+
+std::string optimizeInstructions(const std::string &text);
+void writePeepholeStats(std::ostream &ostr);
+
+# endif /* PEEPHOLE_H */
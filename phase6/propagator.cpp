@@ -0,0 +1,652 @@
+/*
+ * File:	propagator.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		propagating constants in Simple C.
+ *
+ *		We walk each function forwards keeping the value of every
+ *		private variable known to be a constant.  An assignment of
+ *		a constant records its value, and any other assignment
+ *		forgets it.  At a join, only the constants that agree along
+ *		every path that reaches it are kept, and a branch whose test
+ *		is a constant is only ever taken one way, so the constants
+ *		along the other branch are ignored.  A loop is walked
+ *		repeatedly until the constants at its top no longer change,
+ *		optimistically assuming at first that the constants on entry
+ *		still hold along the back edge.
+ *
+ *		Once the constants are known, any use of a constant variable
+ *		is replaced with a number, and any expression whose operands
+ *		are then numbers is folded.  Unreachable code, including
+ *		any branch whose test is now a number, is removed later by
+ *		the code generator.  We only rewrite the tree once a loop
+ *		has been fully walked, and only fold numbers that fit in an
+ *		immediate operand.
+ */
+
+# include <climits>
+# include "Tree.h"
+# include "alias.h"
+# include "machine.h"
+
+using namespace std;
+
+static bool reachable, rewriting;
+static bool returning, breaking;
+static Constants returned, broken;
+static map<const Statement *, Constants> tops;
+
+
+/*
+ * Function:	meet (private)
+ *
+ * Description:	Meet the given state with another state at a join,
+ *		keeping only the constants that agree in both.  An
+ *		unreachable state has no effect.
+ */
+
+static void meet(Constants &constants, bool &reached,
+		 const Constants &other, bool otherReached)
+{
+    if (!otherReached)
+	return;
+
+    if (!reached) {
+	constants = other;
+	reached = true;
+	return;
+    }
+
+    for (auto it = constants.begin(); it != constants.end(); ) {
+	auto entry = other.find(it->first);
+
+	if (entry == other.end() || entry->second != it->second)
+	    it = constants.erase(it);
+	else
+	    ++ it;
+    }
+}
+
+
+/*
+ * Function:	Expression::constant
+ *
+ * Description:	Return whether this expression is a constant given the
+ *		constant variables, and if so its value.  By default, an
+ *		expression is not a constant.
+ */
+
+bool Expression::constant(const Constants &constants, long &value) const
+{
+    return false;
+}
+
+
+/*
+ * Function:	Number::constant
+ *
+ * Description:	Return the value of a number, which is always a
+ *		constant.
+ */
+
+bool Number::constant(const Constants &constants, long &value) const
+{
+    unsigned long number;
+
+
+    isNumber(number);
+    value = number;
+    return true;
+}
+
+
+/*
+ * Function:	Identifier::constant
+ *
+ * Description:	Return whether an identifier is a constant, which is true
+ *		if it names a private variable with a known value.
+ */
+
+bool Identifier::constant(const Constants &constants, long &value) const
+{
+    auto entry = constants.find(_symbol);
+
+
+    if (entry == constants.end() || !Location(this).isPrivate())
+	return false;
+
+    value = entry->second;
+    return true;
+}
+
+
+/*
+ * Function:	Unary::constant
+ *
+ * Description:	Return whether a unary expression is a constant, which
+ *		is true for a logical negation, arithmetic negation,
+ *		bitwise complement, or numeric cast of a constant.
+ */
+
+bool Unary::constant(const Constants &constants, long &value) const
+{
+    long operand;
+
+
+    if (!_type.isNumeric() || !_expr->type().isNumeric())
+	return false;
+
+    if (!_expr->constant(constants, operand))
+	return false;
+
+    if (dynamic_cast<const Not *>(this) != nullptr)
+	value = operand == 0;
+    else if (dynamic_cast<const Negate *>(this) != nullptr)
+	value = _type.normalize(-(unsigned long) operand);
+    else if (dynamic_cast<const Complement *>(this) != nullptr)
+	value = _type.normalize(~operand);
+    else if (dynamic_cast<const Cast *>(this) != nullptr)
+	value = _type.normalize(operand);
+    else
+	return false;
+
+    return true;
+}
+
+
+/*
+ * Function:	Binary::constant
+ *
+ * Description:	Return whether a binary expression is a constant, which
+ *		is true for an arithmetic, bitwise, shift, or comparison
+ *		operator both of whose operands are constants.  A logical
+ *		operator is also a constant if its left operand alone
+ *		determines its value.  Division by zero is never folded,
+ *		nor is any division whose result overflows.  Division,
+ *		comparison, and right shifts of unsigned operands are
+ *		unsigned.  A shift count is masked just as the processor
+ *		masks it.
+ */
+
+bool Binary::constant(const Constants &constants, long &value) const
+{
+    long left, right;
+    bool known, sign;
+    unsigned long u, v;
+    unsigned count;
+
+
+    if (!_type.isNumeric() || !_left->type().isNumeric())
+	return false;
+
+    if (!_right->type().isNumeric() || !_left->constant(constants, left))
+	return false;
+
+    known = _right->constant(constants, right);
+
+    if (dynamic_cast<const LogicalAnd *>(this) != nullptr) {
+	if (left == 0 || known)
+	    value = left != 0 && right != 0;
+
+	return left == 0 || known;
+    }
+
+    if (dynamic_cast<const LogicalOr *>(this) != nullptr) {
+	if (left != 0 || known)
+	    value = left != 0 || right != 0;
+
+	return left != 0 || known;
+    }
+
+    if (!known)
+	return false;
+
+    u = left;
+    v = right;
+    sign = !_left->type().isUnsigned();
+    count = right & (_type.size() == SIZEOF_LONG ? 63 : 31);
+
+    if (dynamic_cast<const Add *>(this) != nullptr)
+	value = (unsigned long) left + right;
+    else if (dynamic_cast<const Subtract *>(this) != nullptr)
+	value = (unsigned long) left - right;
+    else if (dynamic_cast<const Multiply *>(this) != nullptr)
+	value = (unsigned long) left * right;
+    else if (dynamic_cast<const Divide *>(this) != nullptr) {
+	if (right == 0 || (sign && right == -1 && left == LONG_MIN))
+	    return false;
+
+	value = sign ? left / right : u / v;
+
+	if (_type.normalize(value) != value)
+	    return false;
+
+    } else if (dynamic_cast<const Remainder *>(this) != nullptr) {
+	if (right == 0 || (sign && right == -1))
+	    return false;
+
+	value = sign ? left % right : u % v;
+
+    } else if (dynamic_cast<const LeftShift *>(this) != nullptr)
+	value = u << count;
+    else if (dynamic_cast<const RightShift *>(this) != nullptr)
+	value = sign ? left >> count : u >> count;
+    else if (dynamic_cast<const BitwiseAnd *>(this) != nullptr)
+	value = left & right;
+    else if (dynamic_cast<const BitwiseXor *>(this) != nullptr)
+	value = left ^ right;
+    else if (dynamic_cast<const BitwiseOr *>(this) != nullptr)
+	value = left | right;
+    else if (dynamic_cast<const LessThan *>(this) != nullptr)
+	value = sign ? left < right : u < v;
+    else if (dynamic_cast<const GreaterThan *>(this) != nullptr)
+	value = sign ? left > right : u > v;
+    else if (dynamic_cast<const LessOrEqual *>(this) != nullptr)
+	value = sign ? left <= right : u <= v;
+    else if (dynamic_cast<const GreaterOrEqual *>(this) != nullptr)
+	value = sign ? left >= right : u >= v;
+    else if (dynamic_cast<const Equal *>(this) != nullptr)
+	value = left == right;
+    else if (dynamic_cast<const NotEqual *>(this) != nullptr)
+	value = left != right;
+    else
+	return false;
+
+    value = _type.normalize(value);
+    return true;
+}
+
+
+/*
+ * Function:	Expression::fold
+ *
+ * Description:	Fold this expression, returning a number if it is a
+ *		constant whose value fits in an immediate operand, and
+ *		otherwise this expression itself.
+ */
+
+Expression *Expression::fold(Constants &constants)
+{
+    unsigned long number;
+    long value;
+
+
+    if (isNumber(number) || !constant(constants, value))
+	return this;
+
+    if (value != (int) value)
+	return this;
+
+    return new Number(value, _type);
+}
+
+
+/*
+ * Function:	Inline::fold
+ *
+ * Description:	Fold an inlined call by propagating constants through its
+ *		body.  The constants afterwards are those that agree at
+ *		every return within the body.
+ */
+
+Expression *Inline::fold(Constants &constants)
+{
+    Constants savedReturned;
+    bool savedReturning;
+
+
+    savedReturned = returned;
+    savedReturning = returning;
+    returned.clear();
+    returning = false;
+
+    _body->propagate(constants);
+    meet(constants, reachable, returned, returning);
+
+    returned = savedReturned;
+    returning = savedReturning;
+    return this;
+}
+
+
+/*
+ * Function:	Assignment::propagate
+ *
+ * Description:	Propagate constants through an assignment statement.  An
+ *		assignment to a private variable records its value if it
+ *		is a constant that fits in an immediate operand.
+ */
+
+void Assignment::propagate(Constants &constants)
+{
+    const Symbol *symbol;
+    long value;
+
+
+    if (rewriting) {
+	_right = _right->fold(constants);
+
+	if (!_left->isIdentifier(symbol))
+	    _left = _left->fold(constants);
+    }
+
+    if (_left->isIdentifier(symbol) && Location(_left).isPrivate()) {
+	if (_left->type().isNumeric() && _right->constant(constants, value)) {
+	    value = _left->type().normalize(value);
+
+	    if (value == (int) value) {
+		constants[symbol] = value;
+		return;
+	    }
+	}
+
+	constants.erase(symbol);
+    }
+}
+
+
+/*
+ * Function:	Return::propagate
+ *
+ * Description:	Propagate constants through a return statement, after
+ *		which the code is unreachable.  Once rewriting, the
+ *		constants are recorded in case we are within an inlined
+ *		call.
+ */
+
+void Return::propagate(Constants &constants)
+{
+    if (rewriting) {
+	_expr = _expr->fold(constants);
+	meet(returned, returning, constants, true);
+    }
+
+    reachable = false;
+}
+
+
+/*
+ * Function:	Block::propagate
+ *
+ * Description:	Propagate constants through each statement of a block,
+ *		stopping once the rest of the block is unreachable.
+ */
+
+void Block::propagate(Constants &constants)
+{
+    for (auto stmt : _stmts) {
+	if (!reachable)
+	    break;
+
+	stmt->propagate(constants);
+    }
+}
+
+
+/*
+ * Function:	If::propagate
+ *
+ * Description:	Propagate constants through an if statement.  If the
+ *		test is a constant, then only one branch is ever taken.
+ */
+
+void If::propagate(Constants &constants)
+{
+    Constants other;
+    bool reached;
+    long value;
+
+
+    if (rewriting)
+	_expr = _expr->fold(constants);
+
+    if (_expr->constant(constants, value)) {
+	if (value != 0)
+	    _thenStmt->propagate(constants);
+	else if (_elseStmt != nullptr)
+	    _elseStmt->propagate(constants);
+
+	return;
+    }
+
+    other = constants;
+    _thenStmt->propagate(constants);
+    reached = reachable;
+    reachable = true;
+
+    if (_elseStmt != nullptr)
+	_elseStmt->propagate(other);
+
+    meet(constants, reached, other, reachable);
+    reachable = reached;
+}
+
+
+/*
+ * Function:	Switch::propagate
+ *
+ * Description:	Propagate constants through a switch statement.  The
+ *		constants at each case label are those before the switch
+ *		met with those falling into it from the statement before.
+ *		If the value is a constant, then only one label is ever
+ *		taken.  The constants afterwards are those that agree at
+ *		the end and at every break.
+ */
+
+void Switch::propagate(Constants &constants)
+{
+    Constants entry, savedBroken;
+    bool savedBreaking, known, reached;
+    unsigned i, target;
+    long value;
+
+
+    if (rewriting)
+	_expr = _expr->fold(constants);
+
+    target = _default;
+
+    if ((known = _expr->constant(constants, value))) {
+	auto label = _cases.find(value);
+
+	if (label != _cases.end())
+	    target = label->second;
+    }
+
+    entry = constants;
+    savedBroken = broken;
+    savedBreaking = breaking;
+    broken.clear();
+    breaking = reached = false;
+
+    for (i = 0; i <= _stmts.size(); i ++) {
+	if (known ? i == target : labeled(i))
+	    meet(constants, reached, entry, true);
+
+	if (i == _stmts.size() || !reached)
+	    continue;
+
+	reachable = true;
+	_stmts[i]->propagate(constants);
+	reached = reachable;
+    }
+
+    meet(constants, reached, broken, breaking);
+    reachable = reached;
+    broken = savedBroken;
+    breaking = savedBreaking;
+}
+
+
+/*
+ * Function:	Break::propagate
+ *
+ * Description:	Propagate constants through a break statement, after
+ *		which the code is unreachable.  The constants are recorded
+ *		for the end of the switch statement.
+ */
+
+void Break::propagate(Constants &constants)
+{
+    meet(broken, breaking, constants, true);
+    reachable = false;
+}
+
+
+/*
+ * Function:	loop (private)
+ *
+ * Description:	Propagate constants through the test, body, and increment
+ *		of a loop.  The constants at the top of the loop are those
+ *		on entry that still agree at the bottom, which we find by
+ *		walking the loop without rewriting it until they no longer
+ *		change.  The loop is then rewritten using those constants.
+ *		The loop is left only from the test, so the constants
+ *		afterwards are those at the top.
+ *
+ *		The constants on entry only shrink each time an enclosing
+ *		loop walks this one, so we start from those found at the
+ *		top last time, and an inner loop need not iterate again on
+ *		every walk of the outer one.
+ */
+
+static void loop(Expression *&expr, Statement *stmt, Statement *incr,
+		 Constants &constants)
+{
+    Constants top, bottom;
+    bool saved, reached, entered;
+    unsigned size;
+    long value;
+
+
+    top = constants;
+    entered = reachable;
+    saved = rewriting;
+    rewriting = false;
+
+    if (entered && tops.count(stmt) > 0) {
+	reached = true;
+	meet(top, reached, tops[stmt], true);
+    }
+
+    do {
+	bottom = top;
+	size = top.size();
+
+	if (!expr->constant(bottom, value) || value != 0) {
+	    stmt->propagate(bottom);
+
+	    if (reachable && incr != nullptr)
+		incr->propagate(bottom);
+	}
+
+	reached = true;
+	meet(top, reached, bottom, reachable);
+	reachable = true;
+    } while (top.size() != size);
+
+    if (entered)
+	tops[stmt] = top;
+
+    rewriting = saved;
+
+    if (rewriting) {
+	bottom = top;
+	expr = expr->fold(bottom);
+
+	if (!expr->constant(bottom, value) || value != 0) {
+	    stmt->propagate(bottom);
+
+	    if (reachable && incr != nullptr)
+		incr->propagate(bottom);
+	}
+
+	reachable = true;
+    }
+
+    constants = top;
+    reachable = !expr->constant(constants, value) || value == 0;
+}
+
+
+/*
+ * Function:	While::propagate
+ *
+ * Description:	Propagate constants through a while statement.
+ */
+
+void While::propagate(Constants &constants)
+{
+    loop(_expr, _stmt, nullptr, constants);
+}
+
+
+/*
+ * Function:	For::propagate
+ *
+ * Description:	Propagate constants through a for statement, which is
+ *		just like a while statement with an initialization before
+ *		it and an increment at the end of the body.
+ */
+
+void For::propagate(Constants &constants)
+{
+    _init->propagate(constants);
+
+    if (reachable)
+	loop(_expr, _stmt, _incr, constants);
+}
+
+
+/*
+ * Function:	Function::propagate
+ *
+ * Description:	Propagate constants through this function.  Nothing is
+ *		known about any variable on entry.
+ */
+
+void Function::propagate(Constants &constants)
+{
+    reachable = rewriting = true;
+    returning = false;
+    returned.clear();
+    tops.clear();
+    _body->propagate(constants);
+}
+
+
+/*
+ * The remaining functions simply visit the children of each node, and
+ * aren't very interesting.
+ */
+
+void Statement::propagate(Constants &constants)
+{
+}
+
+void Simple::propagate(Constants &constants)
+{
+    if (rewriting)
+	_expr = _expr->fold(constants);
+}
+
+Expression *Unary::fold(Constants &constants)
+{
+    _expr = _expr->fold(constants);
+    return Expression::fold(constants);
+}
+
+Expression *Binary::fold(Constants &constants)
+{
+    _left = _left->fold(constants);
+    _right = _right->fold(constants);
+    return Expression::fold(constants);
+}
+
+Expression *Call::fold(Constants &constants)
+{
+    for (auto &arg : _args)
+	arg = arg->fold(constants);
+
+    return this;
+}
@@ -0,0 +1,553 @@
+/*
+ * File:	ranger.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		finding the ranges of values in Simple C.
+ *
+ *		The range of a private variable is an interval containing
+ *		every value ever assigned to it anywhere in its function,
+ *		regardless of the path taken.  We walk each function
+ *		repeatedly, widening the range of each variable to include
+ *		the range of each value assigned to it, until nothing
+ *		changes.  A range that is still growing after the first few
+ *		walks is widened to the limit of its type, so that the walk
+ *		always ends.  Nothing is known about a parameter, nor about
+ *		a variable that is never assigned, such as one belonging to
+ *		an inlined call, nor about a variable that may be assigned
+ *		a value whose range is not known.
+ *
+ *		The range of an expression is computed from the ranges of
+ *		its operands, and is only known if its value can never
+ *		overflow its type.  The increment of a loop counter cannot
+ *		overflow if the loop test bounds the counter and nothing
+ *		else in the loop assigns to it.
+ *
+ *		Only chars and ints are tracked, so every known range fits
+ *		in a long.  The code generator uses the ranges to omit sign
+ *		extensions of values known to be non-negative.  Every
+ *		expression with a known range is computed by an instruction
+ *		that writes the low double word of its register, which
+ *		clears the rest of the register.
+ */
+
+# include <climits>
+# include "Tree.h"
+# include "alias.h"
+# include "machine.h"
+
+using namespace std;
+
+static unsigned walks;
+
+
+/*
+ * Function:	limits (private)
+ *
+ * Description:	Return whether values of the given type are tracked, and
+ *		if so the smallest and largest values of the type.
+ */
+
+static bool limits(const Type &type, long &low, long &high)
+{
+    if (!type.isNumeric() || type.size() > SIZEOF_INT)
+	return false;
+
+    if (type.size() == 1) {
+	low = type.isUnsigned() ? 0 : SCHAR_MIN;
+	high = type.isUnsigned() ? UCHAR_MAX : SCHAR_MAX;
+    } else {
+	low = type.isUnsigned() ? 0 : INT_MIN;
+	high = type.isUnsigned() ? UINT_MAX : INT_MAX;
+    }
+
+    return true;
+}
+
+
+/*
+ * Function:	fits (private)
+ *
+ * Description:	Return whether the given range fits within the given type,
+ *		so that computing it never overflows.
+ */
+
+static bool fits(const Type &type, long low, long high)
+{
+    long min, max;
+
+
+    if (!limits(type, min, max))
+	return false;
+
+    return low >= min && high <= max;
+}
+
+
+/*
+ * Function:	widen (private)
+ *
+ * Description:	Widen the range of the given variable to include the given
+ *		range.  A range that does not fit within the type of the
+ *		variable is unknown, and is recorded as the range of all
+ *		longs, so that it stays unknown.  Once the variables have
+ *		been walked twice, any range that still grows is widened to
+ *		the limit of its type.
+ */
+
+static void widen(Ranges &ranges, const Symbol *symbol, long low, long high)
+{
+    long min, max;
+
+
+    if (!fits(symbol->type(), low, high)) {
+	low = LONG_MIN;
+	high = LONG_MAX;
+    }
+
+    limits(symbol->type(), min, max);
+    auto entry = ranges.find(symbol);
+
+    if (entry == ranges.end()) {
+	ranges[symbol] = make_pair(low, high);
+	return;
+    }
+
+    if (low < entry->second.first)
+	entry->second.first = walks < 2 || low == LONG_MIN ? low : min;
+
+    if (high > entry->second.second)
+	entry->second.second = walks < 2 || high == LONG_MAX ? high : max;
+}
+
+
+/*
+ * Function:	Expression::range
+ *
+ * Description:	Return whether the range of this expression is known given
+ *		the ranges of the variables, and if so the range.  By
+ *		default, the range of an expression is not known.
+ */
+
+bool Expression::range(const Ranges &ranges, long &low, long &high) const
+{
+    return false;
+}
+
+
+/*
+ * Function:	Number::range
+ *
+ * Description:	Return the range of a number, which is just its value.
+ */
+
+bool Number::range(const Ranges &ranges, long &low, long &high) const
+{
+    unsigned long value;
+
+
+    isNumber(value);
+    low = high = value;
+    return fits(_type, low, high);
+}
+
+
+/*
+ * Function:	Identifier::range
+ *
+ * Description:	Return the range of an identifier, which is known if it
+ *		names a private variable with a known range.
+ */
+
+bool Identifier::range(const Ranges &ranges, long &low, long &high) const
+{
+    auto entry = ranges.find(_symbol);
+
+
+    if (entry == ranges.end() || !Location(this).isPrivate())
+	return false;
+
+    low = entry->second.first;
+    high = entry->second.second;
+    return fits(_type, low, high);
+}
+
+
+/*
+ * Function:	Unary::range
+ *
+ * Description:	Return the range of a unary expression, which is known for
+ *		a logical negation, and for an arithmetic negation, bitwise
+ *		complement, or numeric cast of an operand with a known
+ *		range.
+ */
+
+bool Unary::range(const Ranges &ranges, long &low, long &high) const
+{
+    long first, last;
+
+
+    if (dynamic_cast<const Not *>(this) != nullptr) {
+	low = 0;
+	high = 1;
+	return true;
+    }
+
+    if (!_type.isNumeric() || !_expr->type().isNumeric())
+	return false;
+
+    if (!_expr->range(ranges, first, last))
+	return false;
+
+    if (dynamic_cast<const Negate *>(this) != nullptr) {
+	low = -last;
+	high = -first;
+    } else if (dynamic_cast<const Complement *>(this) != nullptr) {
+	low = ~last;
+	high = ~first;
+    } else if (dynamic_cast<const Cast *>(this) != nullptr) {
+	low = first;
+	high = last;
+    } else
+	return false;
+
+    return fits(_type, low, high);
+}
+
+
+/*
+ * Function:	Binary::range
+ *
+ * Description:	Return the range of a binary expression.  A comparison or
+ *		logical operator is always zero or one.  The range of an
+ *		arithmetic operator is known if the ranges of its operands
+ *		are known, although only a division, remainder, or right
+ *		shift by a positive constant, and a bitwise-and with a
+ *		non-negative operand, are considered.
+ */
+
+bool Binary::range(const Ranges &ranges, long &low, long &high) const
+{
+    long a, b, c, d, min, max;
+    unsigned long value;
+
+
+    if (dynamic_cast<const LessThan *>(this) != nullptr ||
+	dynamic_cast<const GreaterThan *>(this) != nullptr ||
+	dynamic_cast<const LessOrEqual *>(this) != nullptr ||
+	dynamic_cast<const GreaterOrEqual *>(this) != nullptr ||
+	dynamic_cast<const Equal *>(this) != nullptr ||
+	dynamic_cast<const NotEqual *>(this) != nullptr ||
+	dynamic_cast<const LogicalAnd *>(this) != nullptr ||
+	dynamic_cast<const LogicalOr *>(this) != nullptr) {
+	low = 0;
+	high = 1;
+	return true;
+    }
+
+    if (!limits(_type, min, max))
+	return false;
+
+    if (!_left->range(ranges, a, b) || !_right->range(ranges, c, d))
+	return false;
+
+    if (dynamic_cast<const Add *>(this) != nullptr) {
+	low = a + c;
+	high = b + d;
+
+    } else if (dynamic_cast<const Subtract *>(this) != nullptr) {
+	low = a - d;
+	high = b - c;
+
+    } else if (dynamic_cast<const Multiply *>(this) != nullptr) {
+	if (a < INT_MIN || b > INT_MAX || c < INT_MIN || d > INT_MAX)
+	    return false;
+
+	low = std::min(std::min(a * c, a * d), std::min(b * c, b * d));
+	high = std::max(std::max(a * c, a * d), std::max(b * c, b * d));
+
+    } else if (dynamic_cast<const BitwiseAnd *>(this) != nullptr) {
+	if (a < 0 && c < 0)
+	    return false;
+
+	low = 0;
+	high = (a < 0 ? d : (c < 0 ? b : std::min(b, d)));
+
+    } else {
+	if (!_right->isNumber(value) || c <= 0)
+	    return false;
+
+	if (dynamic_cast<const Divide *>(this) != nullptr) {
+	    low = a / c;
+	    high = b / c;
+
+	} else if (dynamic_cast<const Remainder *>(this) != nullptr) {
+	    low = (a < 0 ? 1 - c : 0);
+	    high = (b < 0 ? 0 : std::min(b, c - 1));
+
+	} else if (dynamic_cast<const RightShift *>(this) != nullptr) {
+	    if (a < 0 || c >= (long) _type.size() * 8)
+		return false;
+
+	    low = a >> c;
+	    high = b >> c;
+
+	} else
+	    return false;
+    }
+
+    return fits(_type, low, high);
+}
+
+
+/*
+ * Function:	step (private)
+ *
+ * Description:	Return whether the given statement is an increment of a
+ *		private variable by a constant, i = i + c or i = i - c, and
+ *		if so the variable and the signed constant.
+ */
+
+static bool step(Statement *stmt, const Symbol *&symbol, long &value)
+{
+    Assignment *assign;
+    Binary *binary;
+    const Symbol *other;
+    unsigned long number;
+
+
+    if ((assign = dynamic_cast<Assignment *>(stmt)) == nullptr)
+	return false;
+
+    if (!assign->left()->isIdentifier(symbol))
+	return false;
+
+    if (!Location(assign->left()).isPrivate())
+	return false;
+
+    if ((binary = dynamic_cast<Binary *>(assign->right())) == nullptr)
+	return false;
+
+    if (!binary->left()->isIdentifier(other) || other != symbol)
+	return false;
+
+    if (!binary->right()->isNumber(number) || (long) number <= 0)
+	return false;
+
+    if (dynamic_cast<Add *>(binary) != nullptr)
+	value = number;
+    else if (dynamic_cast<Subtract *>(binary) != nullptr)
+	value = - (long) number;
+    else
+	return false;
+
+    return binary->type() == symbol->type();
+}
+
+
+/*
+ * Function:	increment (private)
+ *
+ * Description:	Widen the ranges for the increment at the end of a loop
+ *		with the given test and body.  An increment of a counter
+ *		that is compared against a bound by the test, and that is
+ *		not otherwise assigned within the body, can only go past
+ *		the bound by the constant, and so needn't be widened to
+ *		the limit of its type.
+ */
+
+static void increment(Expression *test, Statement *incr, Statement *body,
+		      Ranges &ranges)
+{
+    const Symbol *symbol, *counter;
+    long value, low, high, first, last;
+    Binary *compare;
+
+
+    if (!step(incr, symbol, value) || body->assigns(symbol)) {
+	incr->bound(ranges);
+	return;
+    }
+
+    if ((compare = dynamic_cast<Binary *>(test)) == nullptr) {
+	incr->bound(ranges);
+	return;
+    }
+
+    if (!compare->left()->isIdentifier(counter) || counter != symbol) {
+	incr->bound(ranges);
+	return;
+    }
+
+    if (!compare->left()->range(ranges, low, high)) {
+	incr->bound(ranges);
+	return;
+    }
+
+    if (!compare->right()->range(ranges, first, last)) {
+	if (!limits(compare->right()->type(), first, last)) {
+	    incr->bound(ranges);
+	    return;
+	}
+    }
+
+    if (dynamic_cast<LessThan *>(test) != nullptr)
+	high = std::min(high, last - 1);
+    else if (dynamic_cast<LessOrEqual *>(test) != nullptr)
+	high = std::min(high, last);
+    else if (dynamic_cast<GreaterThan *>(test) != nullptr)
+	low = std::max(low, first + 1);
+    else if (dynamic_cast<GreaterOrEqual *>(test) != nullptr)
+	low = std::max(low, first);
+    else {
+	incr->bound(ranges);
+	return;
+    }
+
+    widen(ranges, symbol, low + value, high + value);
+}
+
+
+/*
+ * Function:	Statement::bound
+ *
+ * Description:	Widen the ranges of the variables to include the values
+ *		assigned within this statement.  By default, a statement
+ *		assigns nothing.
+ */
+
+void Statement::bound(Ranges &ranges)
+{
+}
+
+
+/*
+ * Function:	Assignment::bound
+ *
+ * Description:	Widen the ranges for an assignment statement.  The range
+ *		of a private variable is widened to include the range of
+ *		the value assigned, which may not be known.
+ */
+
+void Assignment::bound(Ranges &ranges)
+{
+    const Symbol *symbol;
+    long low, high;
+
+
+    if (!_left->isIdentifier(symbol) || !Location(_left).isPrivate())
+	return;
+
+    if (!limits(_left->type(), low, high))
+	return;
+
+    if (!_right->range(ranges, low, high)) {
+	low = LONG_MIN;
+	high = LONG_MAX;
+    }
+
+    widen(ranges, symbol, low, high);
+}
+
+
+/*
+ * Function:	While::bound
+ *
+ * Description:	Widen the ranges for a while statement.  If the last
+ *		statement of the body is an increment, then it is treated
+ *		just like the increment of a for statement.
+ */
+
+void While::bound(Ranges &ranges)
+{
+    Block *block;
+    Statements stmts;
+
+
+    block = dynamic_cast<Block *>(_stmt);
+
+    if (block == nullptr || block->statements().empty()) {
+	_stmt->bound(ranges);
+	return;
+    }
+
+    stmts = block->statements();
+
+    for (unsigned i = 0; i + 1 < stmts.size(); i ++)
+	stmts[i]->bound(ranges);
+
+    stmts.pop_back();
+    Block rest(block->declarations(), stmts);
+    increment(_expr, block->statements().back(), &rest, ranges);
+}
+
+
+/*
+ * Function:	For::bound
+ *
+ * Description:	Widen the ranges for a for statement.
+ */
+
+void For::bound(Ranges &ranges)
+{
+    _init->bound(ranges);
+    _stmt->bound(ranges);
+    increment(_expr, _incr, _stmt, ranges);
+}
+
+
+/*
+ * Function:	Function::bound
+ *
+ * Description:	Find the ranges of the private variables within this
+ *		function by walking it until nothing changes.  The range of
+ *		a parameter is never known, since its register may hold
+ *		anything in its upper half on entry.
+ */
+
+void Function::bound(Ranges &ranges)
+{
+    const Symbols &symbols = _body->declarations()->symbols();
+    Ranges previous;
+    long low, high;
+
+
+    ranges.clear();
+
+    for (unsigned i = 0; i < _id->type().parameters()->size(); i ++)
+	if (limits(symbols[i]->type(), low, high))
+	    ranges[symbols[i]] = make_pair(LONG_MIN, LONG_MAX);
+
+    walks = 0;
+
+    do {
+	previous = ranges;
+	_body->bound(ranges);
+	walks ++;
+    } while (ranges != previous);
+}
+
+
+/*
+ * The remaining functions simply visit the statements within each
+ * statement, and aren't very interesting.
+ */
+
+void Block::bound(Ranges &ranges)
+{
+    for (auto stmt : _stmts)
+	stmt->bound(ranges);
+}
+
+void If::bound(Ranges &ranges)
+{
+    _thenStmt->bound(ranges);
+
+    if (_elseStmt != nullptr)
+	_elseStmt->bound(ranges);
+}
+
+void Switch::bound(Ranges &ranges)
+{
+    for (auto stmt : _stmts)
+	stmt->bound(ranges);
+}
@@ -15,14 +15,24 @@ enum {
     STAR = '*', DIV = '/', REM = '%', ADDR = '&', NOT = '!', DOT = '.',
     LPAREN = '(', RPAREN = ')', LBRACK = '[', RBRACK = ']',
     LBRACE = '{', RBRACE = '}', SEMI = ';', COLON = ':', COMMA = ',',
+    BAR = '|', CARET = '^', TILDE = '~',
 
     AUTO = 256, BREAK, CASE, CHAR, CONST, CONTINUE, DEFAULT, DO, DOUBLE,
     ELSE, ENUM, EXTERN, FLOAT, FOR, GOTO, IF, INT, LONG, REGISTER,
     RETURN, SHORT, SIGNED, SIZEOF, STATIC, STRUCT, SWITCH, TYPEDEF,
     UNION, UNSIGNED, VOID, VOLATILE, WHILE,
 
-    OR, AND, EQL, NEQ, LEQ, GEQ, INC, DEC, ARROW,
+    OR, AND, EQL, NEQ, LEQ, GEQ, INC, DEC, ARROW, SHL, SHR,
+    ADD_ASSIGN, SUB_ASSIGN, MUL_ASSIGN, DIV_ASSIGN, REM_ASSIGN,
+    AND_ASSIGN, OR_ASSIGN, XOR_ASSIGN, SHL_ASSIGN, SHR_ASSIGN,
     ID, NUM, STRING, CHARACTER, ERROR, DONE = 0
 };
 
+/* The unsigned types are written with two tokens, and so their specifiers
+   are not tokens themselves. */
+
+enum {
+    UNSIGNED_CHAR = 512, UNSIGNED_INT, UNSIGNED_LONG
+};
+
 # endif /* TOKENS_H */
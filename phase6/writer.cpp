@@ -58,6 +58,10 @@ void Number::write(ostream &ostr) const
 
     if (_type.specifier() == LONG)
 	ostr << "L";
+    else if (_type.specifier() == UNSIGNED_INT)
+	ostr << "U";
+    else if (_type.specifier() == UNSIGNED_LONG)
+	ostr << "UL";
 }
 
 void Call::write(ostream &ostr) const
@@ -70,6 +74,11 @@ void Call::write(ostream &ostr) const
     ostr << ")";
 }
 
+void Inline::write(ostream &ostr) const
+{
+    ostr << "(inline " << _id->name() << " " << _body << ")";
+}
+
 void Not::write(ostream &ostr) const
 {
     ostr << "(! " << _expr << ")";
@@ -80,6 +89,11 @@ void Negate::write(ostream &ostr) const
     ostr << "(- " << _expr << ")";
 }
 
+void Complement::write(ostream &ostr) const
+{
+    ostr << "(~ " << _expr << ")";
+}
+
 void Dereference::write(ostream &ostr) const
 {
     ostr << "(* " << _expr << ")";
@@ -119,6 +133,16 @@ void Subtract::write(ostream &ostr) const
     ostr << "(- " << _left << " " << _right << ")";
 }
 
+void LeftShift::write(ostream &ostr) const
+{
+    ostr << "(<< " << _left << " " << _right << ")";
+}
+
+void RightShift::write(ostream &ostr) const
+{
+    ostr << "(>> " << _left << " " << _right << ")";
+}
+
 void LessThan::write(ostream &ostr) const
 {
     ostr << "(< " << _left << " " << _right << ")";
@@ -149,6 +173,21 @@ void NotEqual::write(ostream &ostr) const
     ostr << "(!= " << _left << " " << _right << ")";
 }
 
+void BitwiseAnd::write(ostream &ostr) const
+{
+    ostr << "(& " << _left << " " << _right << ")";
+}
+
+void BitwiseXor::write(ostream &ostr) const
+{
+    ostr << "(^ " << _left << " " << _right << ")";
+}
+
+void BitwiseOr::write(ostream &ostr) const
+{
+    ostr << "(| " << _left << " " << _right << ")";
+}
+
 void LogicalAnd::write(ostream &ostr) const
 {
     ostr << "(&& " << _left << " " << _right << ")";
@@ -200,6 +239,30 @@ void If::write(ostream &ostr) const
     ostr << ")";
 }
 
+void Switch::write(ostream &ostr) const
+{
+    ostr << "(switch " << _expr;
+
+    for (unsigned i = 0; i <= _stmts.size(); i ++) {
+	for (auto &entry : _cases)
+	    if (entry.second == i)
+		ostr << " (case " << entry.first << ")";
+
+	if (_default == i)
+	    ostr << " (default)";
+
+	if (i < _stmts.size())
+	    ostr << " " << _stmts[i];
+    }
+
+    ostr << ")";
+}
+
+void Break::write(ostream &ostr) const
+{
+    ostr << "(break)";
+}
+
 void Simple::write(ostream &ostr) const
 {
     ostr << _expr;